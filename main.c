@@ -48,31 +48,90 @@
 
      ... and then it runs two more times ...
  */
+// mmap(), pthreads, sockets and st_mtim are POSIX and MAP_ANONYMOUS a common extension, not plain C
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
 #include <stdio.h>    // for printf(), scanf()
 #include <stdlib.h>   // for exit( -1)
 #include <string.h>   // for strcpy
 #include <assert.h>   // for assert() sanity checks
 #include <ctype.h>    // for toupper()
 #include <time.h>     // for time()
+#include <pthread.h>  // for the worker pool threads
+#include <stdatomic.h> // for atomic_int, used to hand out work to the worker pool threads
+#include <unistd.h>   // for sysconf()
+#include <math.h>     // for log2(), used for the entropy of guesses
+#include <limits.h>   // for LLONG_MAX
+#include <fcntl.h>    // for open()
+#include <sys/mman.h> // for mmap(), to read words files
+#include <sys/stat.h> // for fstat()
+#include <sys/wait.h> // for waitpid(), to collect scoring shards
+#include <sys/socket.h> // for the server's Unix socket
+#include <sys/un.h>   // for sockaddr_un
+#include <signal.h>   // for signal(), to ignore SIGPIPE while serving
+#include <stdarg.h>   // for va_list, to build server answers
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h> // for the SSE2/AVX2 scoring kernel
+#endif
 
 // Declare globals
-#define WORD_LENGTH 5     // All words have 5 letters, + 1 NULL at the end when stored
+#define MIN_WORD_LENGTH 4 // Shortest words a dictionary can have
+#define MAX_WORD_LENGTH 8 // Longest words a dictionary can have, + 1 NULL at the end when stored
+// Stamp out F( length) for every word length, to compile code specialized on each of them
+#define FOR_EACH_WORD_LENGTH(F) F(4) F(5) F(6) F(7) F(8)
 //#define WORDS_FILE_NAME "wordsLarge.txt"
 #define WORDS_FILE_NAME  "wordsTiny.txt"
-#define MAX_NUMBER_OF_WORDS 12947   // Number of words in the full set of words file
+#define MAX_NUMBER_OF_PATTERNS 6561 // 3^MAX_WORD_LENGTH feedback patterns: every letter is grey, yellow or green
+#define BYTE_PATTERNS_WORD_LENGTH 5 // Longest words whose 3^length feedback patterns fit in a byte
+#define PATTERN_GREY 0              // Pattern digit: letter is not in the word
+#define PATTERN_YELLOW 1            // Pattern digit: letter is in the word, but elsewhere
+#define PATTERN_GREEN 2             // Pattern digit: letter is in the right position
+#define LETTER_CODE_BITS 5          // Bits per letter code in a packed word
+#define PACKED_CODES_PER_WORD 6     // Letter codes that fit in one 32 bit word of a packed word
+#define PACKED_LETTER_WORDS 2       // 32 bit words of letter codes in a packed word, enough for MAX_WORD_LENGTH codes
+#define PACKED_LETTERS_MASK 0x3FFFFFFF // All PACKED_CODES_PER_WORD letter codes of a 32 bit word
+#define ANSWER_BLANK_CODE 31        // Letter code of anything but 'a'..'z' in a packed answer
+#define GUESS_BLANK_CODE 30         // Letter code of anything but 'a'..'z' in a packed guess
+#define PACKED_BLOCK_SIZE 32        // Packed answers are padded to a multiple of this for the scoring kernel
+#define MAX_ANSWER_WEIGHT 32767     // Most answers one weighted packed answer can stand for
+#define SCORE_CHUNK_SIZE 64         // Guess words a worker pool thread scores at a time
+#define SCRATCH_ALIGNMENT 64        // Alignment of scratch arena buffers, a cache line
+#define SCRATCH_BLOCK_SIZE 1048576  // Bytes of the first block of a scratch arena
+#define ENTROPY_FIXED_POINT_SCALE 1048576.0  // Scale of the fixed point c * log2(c) values the solver adds up
+#define PATTERN_BITSETS_LIMIT 64    // Most guess words the solver keeps feedback pattern sets of
+#define LOOKAHEAD_MEMO_ENTRIES 1048576 // Candidate set values the lookahead remembers, a power of 2
+#define LOOKAHEAD_MEMO_LOCKS 64     // Locks guarding the lookahead memo table, each for a share of its entries
+#define LOOKAHEAD_SHOWN 10          // Opening guesses the lookahead lists unless --top says otherwise
+#define WORST_CASE_LEVELS 8         // Guesses the worst case analysis lists the most answer words left after
+#define WORST_CASE_BUCKETS_SHOWN 5  // Biggest buckets of an opening guess the worst case analysis lists
+#define WORST_CASE_BATCH_SIZE 64    // Opening guesses the worst case analysis partitions the answer words by at a time
+#define MAX_INVALID_WORDS_SHOWN 5   // Tokens of a words file that are not words are only listed up to this many
+#define WORD_CACHE_SUFFIX ".cache"  // Added to a words file name for the name of its word cache
+#define WORD_CACHE_MAGIC "WRDCACHE" // First 8 bytes of a word cache file
+#define WORD_CACHE_VERSION 2        // Changed whenever the layout of word cache files changes
+#define RANKING_CACHE_MAGIC "WRDRANK1" // First 8 bytes of a ranking cache file
+#define RANKING_CACHE_VERSION 2     // Changed whenever the layout of ranking cache files changes
+#define RANKING_SCORING_MODE 1      // Changed whenever scoreAssigning(..) scores words differently
+#define FNV_OFFSET_BASIS 14695981039346656037ULL  // Starting value of a 64 bit FNV-1a hash
+#define FNV_PRIME 1099511628211ULL  // Multiplier of the 64 bit FNV-1a hash
+#define DECISION_TREE_MAGIC "WRDTREE1" // First 8 bytes of a tree file
+#define DECISION_TREE_VERSION 2     // Changed whenever the layout of tree files changes
 #define true 1   // Make boolean logic easier to understand
 #define false 0  // Make boolean logic easier to understand
 
 /*
  * struct: wordCountStruct
- * member variables: (char[6]) word, (int) score
- * word: an accepted word of 5 letters, with a null string char
+ * member variables: (char[9]) word, (int) score, (int) index
+ * word: an accepted word of MIN_WORD_LENGTH to MAX_WORD_LENGTH letters (all words of a dictionary have the same
+ * length), with a null string char
  * score: score to be assigned to each word relative to how 'good' it is to be a guess word.
+ * index: position of the word in the words file, kept with the word through sorting so it can look up its feedback patterns.
  */
 typedef struct wordCount wordCountStruct;
 struct wordCount{
-    char word[ WORD_LENGTH + 1];   // The word length plus NULL
+    char word[ MAX_WORD_LENGTH + 1]; // The word length plus NULL
     int score;                     // Score for the word
+    int index;                     // Position of the word in the file it was read from
 };
 
 typedef struct letterCount letterCountStruct;
@@ -80,17 +139,168 @@ struct letterCount{
     char letter;          // The letter character
     int appearances;      // Appearance count of the letter
 };
+//-----------------------------------------------------------------------------------------
+// Statistics.  Built with -DWORDLE_STATS, the program times its phases on a monotonic clock
+// and counts the work done in its hot paths, and --stats reports them when it exits, as a
+// table and optionally as JSON.  Without it the STATS_ macros are empty, so the timers and
+// counters cost nothing.  Phases are timed inclusively, each call from start to end, and
+// calls on several threads at once add up, so a phase can take longer than the wall clock.
+// Counters are added to once per call or per range of items, not per item, to keep them
+// out of the inner loops.  Comparators are called once per item, so they count into a
+// thread's pending counts instead, which the sort or selection adds once when it is done.
+
+/*
+ * Phases the statistics time, each named in statsPhaseNames[].
+ */
+enum statsPhase{
+    STATS_LOAD,            // Reading words files
+    STATS_MATRIX,          // Building the feedback matrix
+    STATS_SCORE,           // Scoring words against packed answers
+    STATS_BLANK,           // Blanking out and merging answers for the second words
+    STATS_SORT,            // Sorting words by score
+    STATS_GUESS,           // Working out a guess of a game
+    STATS_GAME,            // Playing a game
+    STATS_TREE,            // Building the decision tree
+    STATS_LOOKAHEAD,       // Searching opening guesses ahead
+    STATS_WORST_CASE,      // Analyzing the worst case of opening guesses
+    STATS_PHASES           // Number of phases
+};
+
+/*
+ * Counters of the statistics, each named in statsCounterNames[].
+ */
+enum statsCounter{
+    STATS_PAIRS,           // Guess and answer word pairs evaluated, scored or looked up in the feedback matrix
+    STATS_COMPARISONS,     // Word comparisons made sorting and selecting words
+    STATS_ALLOCATIONS,     // Heap allocations of word arrays, packed answers, candidate sets and arena blocks
+    STATS_GUESSES,         // Guesses worked out
+    STATS_COUNTERS         // Number of counters
+};
+
+#ifdef WORDLE_STATS
+static const char *const statsPhaseNames[ STATS_PHASES] = {
+    "load", "matrix", "score", "blank", "sort", "guess", "game", "tree", "lookahead", "worstCase"
+};
+static const char *const statsCounterNames[ STATS_COUNTERS] = {
+    "pairEvaluations", "comparisons", "allocations", "guesses"
+};
+static atomic_llong statsPhaseNanoseconds[ STATS_PHASES];  // Time spent in each phase
+static atomic_llong statsPhaseCalls[ STATS_PHASES];        // Times each phase was entered
+static atomic_llong statsCounters[ STATS_COUNTERS];         // Value of each counter
+static __thread long long statsPendingCounts[ STATS_COUNTERS]; // Counted by this thread, not added to the counters yet
+static char *statsJsonFileName = NULL;                      // File to write the statistics to as JSON, NULL for none
+static double statsStartSeconds = 0;                        // When the statistics were turned on, on the monotonic clock
+
+/*
+ * Nanoseconds on a monotonic clock, for the phase timers.
+ */
+long long statsNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+void statsAddPhase(int phase, long long startNanoseconds) {
+    atomic_fetch_add_explicit(statsPhaseNanoseconds + phase, statsNanoseconds() - startNanoseconds,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(statsPhaseCalls + phase, 1, memory_order_relaxed);
+}
+
+// Time a phase from STATS_START( timer) to STATS_STOP( timer, phase), in the same block
+#define STATS_START(timer) long long timer = statsNanoseconds()
+#define STATS_STOP(timer, phase) statsAddPhase( phase, timer)
+#define STATS_COUNT(counter, amount) \
+    atomic_fetch_add_explicit( statsCounters + (counter), (long long)(amount), memory_order_relaxed)
+// Count without touching the shared counters, then add what was counted with STATS_FLUSH( counter)
+#define STATS_COUNT_PENDING(counter, amount) (statsPendingCounts[ counter] += (amount))
+#define STATS_FLUSH(counter) \
+    do { STATS_COUNT( counter, statsPendingCounts[ counter]); statsPendingCounts[ counter] = 0; } while (0)
+#else
+#define STATS_START(timer)
+#define STATS_STOP(timer, phase)
+#define STATS_COUNT(counter, amount)
+#define STATS_COUNT_PENDING(counter, amount)
+#define STATS_FLUSH(counter)
+#endif
+
+/*
+ * Report the statistics: a table on stderr, so it stays out of the way of server answers, and the JSON file if one
+ * was asked for. Registered with atexit(..) by --stats.
+ */
+void reportStats() {
+#ifdef WORDLE_STATS
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double wallSeconds = now.tv_sec + now.tv_nsec / 1e9 - statsStartSeconds;
+    fprintf(stderr, "\nStatistics (%.3f s wall clock):\n", wallSeconds);
+    fprintf(stderr, "  %-12s %10s %12s %12s\n", "phase", "calls", "total ms", "mean us");
+    int i = 0;
+    for (; i < STATS_PHASES; i++) {
+        long long calls = atomic_load(statsPhaseCalls + i);
+        long long nanoseconds = atomic_load(statsPhaseNanoseconds + i);
+        if (calls > 0) {
+            fprintf(stderr, "  %-12s %10lld %12.3f %12.3f\n", statsPhaseNames[i], calls, nanoseconds / 1e6,
+                    nanoseconds / 1e3 / calls);
+        }
+    }
+    for (i = 0; i < STATS_COUNTERS; i++) {
+        fprintf(stderr, "  %-16s %lld\n", statsCounterNames[i], (long long)atomic_load(statsCounters + i));
+    }
+    if (statsJsonFileName != NULL) {
+        FILE *jsonFilePtr = fopen(statsJsonFileName, "w");
+        if (jsonFilePtr == NULL) {
+            fprintf(stderr, "Could not write statistics to %s.\n", statsJsonFileName);
+            return;
+        }
+        fprintf(jsonFilePtr, "{\n  \"wallSeconds\": %.6f,\n  \"phases\": {", wallSeconds);
+        for (i = 0; i < STATS_PHASES; i++) {
+            fprintf(jsonFilePtr, "%s\n    \"%s\": {\"calls\": %lld, \"seconds\": %.6f}", i > 0 ? "," : "",
+                    statsPhaseNames[i], (long long)atomic_load(statsPhaseCalls + i),
+                    atomic_load(statsPhaseNanoseconds + i) / 1e9);
+        }
+        fprintf(jsonFilePtr, "\n  },\n  \"counters\": {");
+        for (i = 0; i < STATS_COUNTERS; i++) {
+            fprintf(jsonFilePtr, "%s\n    \"%s\": %lld", i > 0 ? "," : "", statsCounterNames[i],
+                    (long long)atomic_load(statsCounters + i));
+        }
+        fprintf(jsonFilePtr, "\n  }\n}\n");
+        fclose(jsonFilePtr);
+    }
+#endif
+}
+
+/*
+ * Turn on reporting the statistics when the program exits; turning it on again only adds the JSON file.
+ * Param: (char[]) file to write them to as JSON as well, or NULL
+ */
+void enableStats(char jsonFileName[]) {
+#ifdef WORDLE_STATS
+    if (statsStartSeconds == 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        statsStartSeconds = now.tv_sec + now.tv_nsec / 1e9;
+        atexit(reportStats);
+    }
+    if (jsonFileName != NULL) {
+        statsJsonFileName = jsonFileName;
+    }
+#else
+    (void)jsonFileName;
+    fprintf(stderr, "This program was built without statistics, build it with -DWORDLE_STATS for --stats.\n");
+#endif
+}
+
 //-----------------------------------------------------------------------------------------
 // Comparator for use in built-in qsort(..) function.  Parameters are declared to be a
 // generic type, so they will match with anything.
-// This is a two-part comparison.  First the scores are compared.  If they are the same,
-// then the words themselves are also compared, so that the results are in descending
-// order by score, and within score they are in alphabetic order.
-int compareFunction( const void * a, const void * b) {
+// This is a two-part comparison.  First the appearances are compared.  If they are the same,
+// then the letters themselves are also compared, so that the results are in descending
+// order by appearances, and within appearances they are in alphabetic order.
+int compareFunctionLetter( const void * a, const void * b) {
     // Before using parameters we have cast them into the actual type they are in our program
     // and then extract the numerical value used in comparison
-    int firstScore = ((wordCountStruct *) a)->score;
-    int secondScore = ((wordCountStruct *) b)->score;
+    int firstScore = ((letterCountStruct *) a)->appearances;
+    int secondScore = ((letterCountStruct *) b)->appearances;
 
     // If scores are different, then that's all we need for our comparison.
     if (firstScore != secondScore) {
@@ -99,366 +309,4673 @@ int compareFunction( const void * a, const void * b) {
         return secondScore - firstScore;      // descending order
     }
     else {
-        // Scores are equal, so check words themselves, to put them in alphabetical order
-        return strcmp( ((wordCountStruct *)a)->word,  ((wordCountStruct *)b)->word );
+        // Scores are equal, so check letters themselves, to put them in alphabetical order
+        return ((letterCountStruct *) a)->letter - ((letterCountStruct *) b)->letter;
+    }
+} //end compareFunctionLetter(..)
+
+/*
+ * Take a word of reference and a word that is choice of guess, assign score to how well-matched the guess word was
+ * to the reference word. With proper precedent,
+ * assign 3 points to a perfectly matched letter of the same position
+ * after assigning all the 3-point possible, assign 1 point if there exists letters matching (at this point, letters are
+ * guaranteed to not be of the same location, so 1-point assignment well-defined).
+ * Written for any word length and inlined into a copy per word length below, so the loops are unrolled.
+ * Param: (char*) word of reference to calculate score on, (char*) word that is guessing to be compared to word of reference,
+ * (int) length of both words
+ * Output: Score of guess word relative to the reference word.
+ */
+static inline __attribute__((always_inline)) int scoreAssigningOfLength(char *wordRef, char *wordGuess, int wordLength) {
+    int scoreAssigned = 0;
+    int k = 0;
+    // first assign the 3-points, match index by index of string, then blank out to indicate the letter not to be counted for
+    // for the loop assigning 1-points.
+    for (; k < wordLength; k++) {
+        if (wordGuess[k] == wordRef[k]) {
+            scoreAssigned += 3;
+            // blanking out used different letters to differentiate (the guess word's 'letter' should not still be found)
+            wordRef[k] = ' ';
+            wordGuess[k] = '-';
+        }
+    }
+    k = 0; // double loop since precise location should take precedent, no
+    // way to ensure that if implementing parallelly
+    for (; k < wordLength; k++) {
+        if (strchr(wordRef, wordGuess[k])) {
+            scoreAssigned += 1;
+            *(strchr(wordRef, wordGuess[k])) = ' ';
+            // don't need to blank pos k of guess word since this is
+            // the last time it is encountered.
+        }
+    }
+    return scoreAssigned;
+}
+
+#define DEFINE_SCORE_ASSIGNING(L) \
+    int scoreAssigning##L(char *wordRef, char *wordGuess) { return scoreAssigningOfLength(wordRef, wordGuess, L); }
+FOR_EACH_WORD_LENGTH(DEFINE_SCORE_ASSIGNING)
+#define SCORE_ASSIGNING_ENTRY(L) scoreAssigning##L,
+static int (*const scoreAssigningOfWordLength[])(char *, char *) = { FOR_EACH_WORD_LENGTH(SCORE_ASSIGNING_ENTRY) };
+
+/*
+ * scoreAssigning..(..) for words of any length from MIN_WORD_LENGTH to MAX_WORD_LENGTH, using the copy made for it.
+ * Param: (char*) word of reference, (char*) word that is guessing, (int) length of both words
+ * Output: Score of guess word relative to the reference word.
+ */
+int scoreAssigning(char *wordRef, char *wordGuess, int wordLength) {
+    return scoreAssigningOfWordLength[wordLength - MIN_WORD_LENGTH](wordRef, wordGuess);
+}
+
+//-----------------------------------------------------------------------------------------
+// Scratch arenas.  Buffers that only live while a function runs (split costs, candidate
+// lists, buckets) are bumped off the calling thread's arena and given back in the reverse
+// order they were taken, instead of going through malloc and free every time.  Each
+// thread has its own arena, so worker pool threads never share one.
+
+/*
+ * struct: scratchBlockStruct
+ * A block of arena memory; the memory handed out starts SCRATCH_ALIGNMENT bytes in, after this header.
+ */
+typedef struct scratchBlock scratchBlockStruct;
+struct scratchBlock{
+    scratchBlockStruct *previous;  // Block that filled up before this one, NULL for the first
+    size_t start;                  // Arena offset of the first byte of the block
+    size_t capacity;               // Bytes of the block that can be handed out
+};
+
+/*
+ * struct: scratchArenaStruct
+ * used: bytes handed out so far, counted across all blocks, which is also the mark to give them back to
+ * When a buffer does not fit, a bigger block is chained on. Blocks handed out entirely after a mark are given back when
+ * the arena is released to it, the biggest one kept as a spare for the next time, so after warming up the arena no
+ * longer calls malloc.
+ */
+typedef struct scratchArena scratchArenaStruct;
+struct scratchArena{
+    scratchBlockStruct *block;  // Block buffers are handed out from, NULL before the first one
+    scratchBlockStruct *spare;  // Block given back, to be reused before allocating another
+    size_t used;                // Bytes handed out, including the unused ends of filled blocks
+};
+
+static __thread scratchArenaStruct threadScratch;  // Scratch arena of each thread
+
+/*
+ * Scratch arena of the calling thread.
+ */
+scratchArenaStruct *threadScratchArena() {
+    return &threadScratch;
+}
+
+/*
+ * Hand out a buffer from an arena, aligned to SCRATCH_ALIGNMENT bytes. It stays valid until the arena is released to a
+ * mark taken before it.
+ * Param: (scratchArenaStruct*) the arena, (size_t) size of the buffer in bytes
+ * Output: The buffer
+ */
+void *arenaAllocate(scratchArenaStruct *arena, size_t size) {
+    size = (size + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT * SCRATCH_ALIGNMENT;
+    scratchBlockStruct *block = arena->block;
+    if (block == NULL || arena->used + size > block->start + block->capacity) {
+        size_t capacity = block != NULL ? 2 * block->capacity : SCRATCH_BLOCK_SIZE;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        scratchBlockStruct *grown = arena->spare;
+        if (grown != NULL && grown->capacity >= capacity) {
+            arena->spare = NULL;
+        }
+        else {
+            grown = (scratchBlockStruct *)aligned_alloc(SCRATCH_ALIGNMENT, SCRATCH_ALIGNMENT + capacity);
+            if (grown == NULL) {
+                printf("Not enough memory for scratch buffers. Exiting...\n");
+                exit(-1);
+            }
+            grown->capacity = capacity;
+            STATS_COUNT(STATS_ALLOCATIONS, 1);
+        }
+        // the rest of the filled block goes unused until the arena is released to before it
+        grown->previous = block;
+        grown->start = arena->used;
+        arena->block = grown;
+        block = grown;
+    }
+    void *buffer = (char *)block + SCRATCH_ALIGNMENT + (arena->used - block->start);
+    arena->used += size;
+    return buffer;
+}
+
+/*
+ * Give back every buffer handed out after a mark.
+ * Param: (scratchArenaStruct*) the arena, (size_t) the mark, arena->used before the buffers were handed out
+ */
+void arenaRelease(scratchArenaStruct *arena, size_t mark) {
+    while (arena->block != NULL && arena->block->previous != NULL && arena->block->start >= mark) {
+        scratchBlockStruct *released = arena->block;
+        arena->block = released->previous;
+        if (arena->spare == NULL || released->capacity > arena->spare->capacity) {
+            free(arena->spare);
+            arena->spare = released;
+        }
+        else {
+            free(released);
+        }
+    }
+    arena->used = mark;
+    // once empty, trade a first block that was too small for the spare, which was big enough
+    if (mark == 0 && arena->block != NULL && arena->spare != NULL && arena->spare->capacity > arena->block->capacity) {
+        free(arena->block);
+        arena->block = arena->spare;
+        arena->block->previous = NULL;
+        arena->block->start = 0;
+        arena->spare = NULL;
+    }
+}
+
+void freeScratchArena(scratchArenaStruct *arena) {
+    arenaRelease(arena, 0);
+    free(arena->block);
+    free(arena->spare);
+    arena->block = NULL;
+    arena->spare = NULL;
+}
+
+//-----------------------------------------------------------------------------------------
+// Worker pool.  A job is a function run over a range of items, like scoring a range of
+// guess words.  workerPoolRun(..) splits the items evenly over the threads of the pool,
+// each thread claims chunks of its own share first and then steals chunks from the shares
+// of the other threads, so threads that finish early keep busy until all items are done.
+// The thread that calls workerPoolRun(..) works on the job too.
+
+typedef void (*workerJobFunction)(void *context, int begin, int end);
+
+/*
+ * struct: workerShareStruct
+ * The items of a job handed to one thread, claimed chunk by chunk by that thread and by threads stealing from it.
+ */
+typedef struct workerShare workerShareStruct;
+struct workerShare{
+    atomic_int next;   // Next item nobody has claimed yet
+    int end;           // One past the last item of the share
+    char padding[ 56]; // Keep each share on its own cache line, they are updated by different threads
+};
+
+typedef struct workerPool workerPoolStruct;
+
+typedef struct workerThread workerThreadStruct;
+struct workerThread{
+    workerPoolStruct *pool;   // Pool the thread belongs to
+    int id;                   // Which share of the job is this thread's own, 0 is the calling thread
+};
+
+/*
+ * struct: workerPoolStruct
+ * threadCount: number of threads working on each job, the thread calling workerPoolRun(..) included
+ * The job fields are only changed while no job is running.
+ */
+struct workerPool{
+    int threadCount;              // Threads working on a job, the calling thread included
+    pthread_t *threads;           // The threadCount - 1 background threads
+    workerThreadStruct *workers;  // Arguments of the background threads
+    workerShareStruct *shares;    // Share of the items of the current job for each thread
+    pthread_mutex_t lock;         // Guards the fields below
+    pthread_cond_t jobReady;      // Signalled when a job is started or the pool shuts down
+    pthread_cond_t jobDone;       // Signalled when the last background thread finishes its part of a job
+    int jobNumber;                // Counts the jobs, so a waking thread knows whether there is a new one
+    int threadsWorking;           // Background threads that have not finished the current job
+    int shuttingDown;             // Set when the pool is freed
+    workerJobFunction job;        // Function of the current job
+    void *context;                // Data of the current job, shared by all threads
+    int chunkSize;                // Items claimed at a time
+};
+
+/*
+ * Work on the current job until no items are left: first the thread's own share, then the shares of the others.
+ * Param: (workerPoolStruct*) the pool, (int) id of the thread
+ */
+void workerPoolWork(workerPoolStruct *pool, int id) {
+    int offset = 0;
+    for (; offset < pool->threadCount; offset++) {
+        workerShareStruct *share = pool->shares + (id + offset) % pool->threadCount;
+        int begin = atomic_fetch_add(&share->next, pool->chunkSize);
+        while (begin < share->end) {
+            int end = begin + pool->chunkSize < share->end ? begin + pool->chunkSize : share->end;
+            pool->job(pool->context, begin, end);
+            begin = atomic_fetch_add(&share->next, pool->chunkSize);
+        }
+    }
+}
+
+/*
+ * Body of each background thread: sleep until a job is started, work on it, report back, repeat until shut down.
+ */
+void *workerThreadMain(void *argument) {
+    workerThreadStruct *worker = (workerThreadStruct *)argument;
+    workerPoolStruct *pool = worker->pool;
+    int jobsSeen = 0;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->jobNumber == jobsSeen && !pool->shuttingDown) {
+            pthread_cond_wait(&pool->jobReady, &pool->lock);
+        }
+        if (pool->shuttingDown) {
+            break;
+        }
+        jobsSeen = pool->jobNumber;
+        pthread_mutex_unlock(&pool->lock);
+        workerPoolWork(pool, worker->id);
+        pthread_mutex_lock(&pool->lock);
+        pool->threadsWorking--;
+        if (pool->threadsWorking == 0) {
+            pthread_cond_signal(&pool->jobDone);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    freeScratchArena(threadScratchArena());
+    return NULL;
+}
+
+/*
+ * Create a worker pool. Must be freed with freeWorkerPool(..).
+ * Param: (int) number of threads to work on jobs, the calling thread included; 0 or less for one per online processor
+ * Output: The pool
+ */
+workerPoolStruct *createWorkerPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (threadCount <= 0) {
+            threadCount = 1;
+        }
+    }
+    workerPoolStruct *pool = (workerPoolStruct *)malloc(sizeof(workerPoolStruct));
+    pool->threadCount = threadCount;
+    pool->threads = (pthread_t *)malloc(sizeof(pthread_t) * threadCount);
+    pool->workers = (workerThreadStruct *)malloc(sizeof(workerThreadStruct) * threadCount);
+    pool->shares = (workerShareStruct *)malloc(sizeof(workerShareStruct) * threadCount);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->jobReady, NULL);
+    pthread_cond_init(&pool->jobDone, NULL);
+    pool->jobNumber = 0;
+    pool->threadsWorking = 0;
+    pool->shuttingDown = false;
+    int i = 1;
+    for (; i < threadCount; i++) {
+        (pool->workers + i)->pool = pool;
+        (pool->workers + i)->id = i;
+        if (pthread_create(pool->threads + i, NULL, workerThreadMain, pool->workers + i) != 0) {
+            printf("Could not start worker thread %d. Exiting...\n", i);
+            exit(-1);
+        }
+    }
+    return pool;
+}
+
+/*
+ * Run a job over items 0 to itemCount - 1 on all threads of the pool, returning once every item is done. The job is
+ * called on ranges of at most chunkSize items, from several threads at the same time, so it must only write to data of
+ * its own items. Without a pool (NULL) or with a single thread the job simply runs over all items on the calling thread.
+ * A job must not start another job on the same pool.
+ * Param: (workerPoolStruct*) the pool or NULL, (workerJobFunction) the job, (void*) data passed to the job, (int) number
+ * of items, (int) how many items a thread claims at a time
+ */
+void workerPoolRun(workerPoolStruct *pool, workerJobFunction job, void *context, int itemCount, int chunkSize) {
+    if (pool == NULL || pool->threadCount == 1 || itemCount <= chunkSize) {
+        if (itemCount > 0) {
+            job(context, 0, itemCount);
+        }
+        return;
+    }
+    int i = 0;
+    for (; i < pool->threadCount; i++) {
+        atomic_store(&(pool->shares + i)->next, (int)((long long)itemCount * i / pool->threadCount));
+        (pool->shares + i)->end = (int)((long long)itemCount * (i + 1) / pool->threadCount);
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->context = context;
+    pool->chunkSize = chunkSize;
+    pool->threadsWorking = pool->threadCount - 1;
+    pool->jobNumber++;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->lock);
+
+    workerPoolWork(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->threadsWorking > 0) {
+        pthread_cond_wait(&pool->jobDone, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void freeWorkerPool(workerPoolStruct *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shuttingDown = true;
+    pthread_cond_broadcast(&pool->jobReady);
+    pthread_mutex_unlock(&pool->lock);
+    int i = 1;
+    for (; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->jobReady);
+    pthread_cond_destroy(&pool->jobDone);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool->shares);
+    free(pool);
+    // the calling thread is thread 0 of the pool
+    freeScratchArena(threadScratchArena());
+}
+
+//-----------------------------------------------------------------------------------------
+// Feedback engine.  The feedback for a guess against an answer is stored as a pattern
+// number in base 3, one digit per letter position (position 0 is the lowest digit), where
+// each digit is PATTERN_GREY, PATTERN_YELLOW or PATTERN_GREEN.  The solver splits and
+// filters its candidate words by these patterns; the 3/1 point score of scoreAssigning(..)
+// does not need them and comes from the packed words instead.
+// Words of up to BYTE_PATTERNS_WORD_LENGTH letters have patterns that fit in a byte, longer
+// ones take two bytes in the feedback matrix.  The code that runs once per pair of words is
+// written for any word length and copied out for each length with FOR_EACH_WORD_LENGTH, so
+// every copy has constant loop bounds; the copy for the dictionary's length is picked from
+// a table at runtime.
+
+/*
+ * struct: feedbackMatrixStruct
+ * patterns: one pattern (patternBytes bytes) per (guess, answer) pair, guessCount rows of answerCount patterns, indexed
+ * by the words' file index
+ * guessCount: number of rows, one per word that can be guessed
+ * answerCount: number of columns, one per answer word, which are the first answerCount words of the file
+ */
+typedef struct feedbackMatrix feedbackMatrixStruct;
+struct feedbackMatrix{
+    unsigned char *patterns;                      // guessCount x answerCount feedback patterns
+    int guessCount;                               // Number of guess words (rows)
+    int answerCount;                              // Number of answer words (columns)
+    int wordLength;                               // Length of the words
+    int patternCount;                             // 3^wordLength patterns
+    int allGreenPattern;                          // Pattern of a guess that is the secret word itself
+    int patternBytes;                             // Bytes per pattern: 1, or 2 if they do not fit in a byte
+};
+
+/*
+ * Number of feedback patterns of words of a length.
+ * Param: (int) word length
+ * Output: 3^wordLength
+ */
+int numberOfPatterns(int wordLength) {
+    int patternCount = 1;
+    int k = 0;
+    for (; k < wordLength; k++) {
+        patternCount *= 3;
+    }
+    return patternCount;
+}
+
+/*
+ * Compute the feedback pattern of a guess word relative to an answer word, matching letters the same way
+ * scoreAssigning(..) does: green letters are matched first, then going left to right each remaining guess letter is
+ * yellow if an unmatched copy of it is left in the answer. Answer characters other than 'a'..'z' (like the blanks left
+ * by secondScoreCompute(..)) never match. Neither word is modified.
+ * Param: (const char[]) answer word of reference, (const char[]) word that is guessing, (int) length of both words
+ * Output: Feedback pattern number, between 0 and 3^wordLength - 1.
+ */
+static inline __attribute__((always_inline)) int feedbackPatternOfLength(const char answer[], const char guess[],
+                                                                         int wordLength) {
+    static const int positionWeight[ MAX_WORD_LENGTH] = {1, 3, 9, 27, 81, 243, 729, 2187};  // 3^position
+    unsigned char unmatchedLetters[ 26];   // Answer letters not used up by a green match
+    memset(unmatchedLetters, 0, sizeof(unmatchedLetters));
+    unsigned int greenPositions = 0;
+    int pattern = 0;
+    int k = 0;
+    for (; k < wordLength; k++) {
+        if (guess[k] == answer[k]) {
+            pattern += PATTERN_GREEN * positionWeight[k];
+            greenPositions |= 1u << k;
+        }
+        else if (answer[k] >= 'a' && answer[k] <= 'z') {
+            unmatchedLetters[answer[k] - 'a']++;
+        }
+    }
+    for (k = 0; k < wordLength; k++) {
+        if (!(greenPositions & (1u << k)) && guess[k] >= 'a' && guess[k] <= 'z' && unmatchedLetters[guess[k] - 'a'] > 0) {
+            pattern += PATTERN_YELLOW * positionWeight[k];
+            unmatchedLetters[guess[k] - 'a']--;
+        }
+    }
+    return pattern;
+}
+
+#define DEFINE_FEEDBACK_PATTERN(L) \
+    int feedbackPattern##L(const char answer[], const char guess[]) { return feedbackPatternOfLength(answer, guess, L); }
+FOR_EACH_WORD_LENGTH(DEFINE_FEEDBACK_PATTERN)
+#define FEEDBACK_PATTERN_ENTRY(L) feedbackPattern##L,
+static int (*const feedbackPatternOfWordLength[])(const char[], const char[]) = {
+    FOR_EACH_WORD_LENGTH(FEEDBACK_PATTERN_ENTRY)
+};
+
+/*
+ * feedbackPatternOfLength(..) for words of any length from MIN_WORD_LENGTH to MAX_WORD_LENGTH, using the copy made for it.
+ * Param: (const char[]) answer word of reference, (const char[]) word that is guessing, (int) length of both words
+ * Output: Feedback pattern number, between 0 and 3^wordLength - 1.
+ */
+int feedbackPattern(const char answer[], const char guess[], int wordLength) {
+    return feedbackPatternOfWordLength[wordLength - MIN_WORD_LENGTH](answer, guess);
+}
+
+/*
+ * Extract the state of one letter position out of a feedback pattern.
+ * Param: (int) feedback pattern number, (int) letter position
+ * Output: PATTERN_GREY, PATTERN_YELLOW or PATTERN_GREEN
+ */
+int patternLetterState(int pattern, int position) {
+    for (; position > 0; position--) {
+        pattern /= 3;
+    }
+    return pattern % 3;
+}
+
+/*
+ * struct: matrixJobStruct
+ * Data shared by the worker pool threads while filling in rows of the feedback matrix.
+ */
+typedef struct matrixJob matrixJobStruct;
+struct matrixJob{
+    feedbackMatrixStruct *matrix;  // The matrix being built
+    wordCountStruct *allWords;     // All words in file order
+};
+
+/*
+ * Worker pool job: fill in the rows from begin to end - 1 of the feedback matrix of a matrixJobStruct, for words of a
+ * given length. Copied out for each word length below.
+ */
+static inline __attribute__((always_inline)) void buildFeedbackMatrixRowsOfLength(void *context, int begin, int end,
+                                                                                  int wordLength) {
+    matrixJobStruct *matrixJob = (matrixJobStruct *)context;
+    wordCountStruct *allWords = matrixJob->allWords;
+    int answerCount = matrixJob->matrix->answerCount;
+    int i = begin;
+    for (; i < end; i++) {
+        assert((allWords + i)->index == i);
+        int j = 0;
+        if (wordLength <= BYTE_PATTERNS_WORD_LENGTH) {
+            unsigned char *row = matrixJob->matrix->patterns + (size_t)i * answerCount;
+            for (; j < answerCount; j++) {
+                row[j] = (unsigned char)feedbackPatternOfLength((allWords + j)->word, (allWords + i)->word, wordLength);
+            }
+        }
+        else {
+            unsigned short *row = (unsigned short *)matrixJob->matrix->patterns + (size_t)i * answerCount;
+            for (; j < answerCount; j++) {
+                row[j] = (unsigned short)feedbackPatternOfLength((allWords + j)->word, (allWords + i)->word, wordLength);
+            }
+        }
+    }
+}
+
+#define DEFINE_BUILD_FEEDBACK_MATRIX_ROWS(L) \
+    void buildFeedbackMatrixRows##L(void *context, int begin, int end) { \
+        buildFeedbackMatrixRowsOfLength(context, begin, end, L); \
+    }
+FOR_EACH_WORD_LENGTH(DEFINE_BUILD_FEEDBACK_MATRIX_ROWS)
+#define BUILD_FEEDBACK_MATRIX_ROWS_ENTRY(L) buildFeedbackMatrixRows##L,
+static const workerJobFunction buildFeedbackMatrixRowsOfWordLength[] = {
+    FOR_EACH_WORD_LENGTH(BUILD_FEEDBACK_MATRIX_ROWS_ENTRY)
+};
+
+/*
+ * Build the feedback matrix once for a dictionary: the pattern of every word as a guess against every answer word.
+ * Words must still be in file order (before any sorting), with the answer words as the first answerCount of them.
+ * Param: (feedbackMatrixStruct*) matrix to fill in, (wordCountStruct[]) all words in file order, (int) number of all
+ * words, (int) number of answer words, (int) length of the words, (workerPoolStruct*) worker pool to fill in rows in
+ * parallel, or NULL
+ */
+void buildFeedbackMatrix(feedbackMatrixStruct *matrix, wordCountStruct allWords[], int wordCount, int answerCount,
+                         int wordLength, workerPoolStruct *pool) {
+    matrix->guessCount = wordCount;
+    matrix->answerCount = answerCount;
+    matrix->wordLength = wordLength;
+    matrix->patternCount = numberOfPatterns(wordLength);
+    matrix->allGreenPattern = matrix->patternCount - 1;
+    matrix->patternBytes = wordLength <= BYTE_PATTERNS_WORD_LENGTH ? 1 : 2;
+    matrix->patterns = (unsigned char *)malloc((size_t)wordCount * answerCount * matrix->patternBytes);
+    if (matrix->patterns == NULL) {
+        printf("Not enough memory for the %d x %d feedback matrix. Exiting...\n", wordCount, answerCount);
+        exit(-1);
+    }
+    STATS_START(timer);
+    matrixJobStruct matrixJob;
+    matrixJob.matrix = matrix;
+    matrixJob.allWords = allWords;
+    workerPoolRun(pool, buildFeedbackMatrixRowsOfWordLength[wordLength - MIN_WORD_LENGTH], &matrixJob, wordCount,
+                  SCORE_CHUNK_SIZE);
+    STATS_COUNT(STATS_PAIRS, (long long)wordCount * answerCount);
+    STATS_STOP(timer, STATS_MATRIX);
+}
+
+/*
+ * Feedback patterns of one guess word against all the answer words, patternBytes bytes each; read them with
+ * feedbackMatrixPattern(..), or as unsigned char or unsigned short when the size is known.
+ * Param: (const feedbackMatrixStruct*) the feedback matrix, (int) file index of the guess word
+ * Output: Pointer to answerCount patterns, indexed by the answer words' file index
+ */
+const unsigned char *feedbackMatrixRow(const feedbackMatrixStruct *matrix, int guessIndex) {
+    return matrix->patterns + (size_t)guessIndex * matrix->answerCount * matrix->patternBytes;
+}
+
+/*
+ * One pattern of a row of the feedback matrix.
+ * Param: (const feedbackMatrixStruct*) the feedback matrix, (const unsigned char*) row from feedbackMatrixRow(..),
+ * (int) file index of the answer word
+ * Output: Feedback pattern of the row's guess against the answer word
+ */
+int feedbackMatrixPattern(const feedbackMatrixStruct *matrix, const unsigned char *row, int answerIndex) {
+    if (matrix->patternBytes == 1) {
+        return row[answerIndex];
+    }
+    return ((const unsigned short *)row)[answerIndex];
+}
+
+void freeFeedbackMatrix(feedbackMatrixStruct *matrix) {
+    free(matrix->patterns);
+    matrix->patterns = NULL;
+}
+
+//-----------------------------------------------------------------------------------------
+// Packed words.  A word is packed into a 5 bit letter code per position plus one 26 bit
+// letter mask per repeat count, so the 3/1 point score of a guess against an answer can be
+// worked out with a few bit operations instead of character scans:
+//   score = 3 * greens + yellows = 2 * greens + (letters the two words have in common),
+// where greens are the letter codes that are equal, and the letters in common (counting
+// repeats) are the bits the letter masks of the two words share, summed over all layers.
+// Letter codes are packed PACKED_CODES_PER_WORD to a 32 bit word, so words longer than that
+// take a second one; which codes of each word are in use is kept as its green bits.
+
+/*
+ * struct: packedWordStruct
+ * letters: letter code (0 for 'a' .. 25 for 'z') of position k in bits 5k to 5k+4 of the first word, position
+ * PACKED_CODES_PER_WORD + k in bits 5k to 5k+4 of the second one
+ * letterMasks: letterMasks[ 0] has bit c set if letter c is in the word (the presence mask), letterMasks[ n] if it is in
+ * the word more than n times, so the per-letter counts of the word are stored as layers of masks.
+ */
+typedef struct packedWord packedWordStruct;
+struct packedWord{
+    unsigned int letters[ PACKED_LETTER_WORDS];  // Letter codes, position 0 in the lowest bits
+    unsigned int letterMasks[ MAX_WORD_LENGTH];  // Letters in the word at least n+1 times in letterMasks[ n]
+};
+
+/*
+ * struct: packedAnswersStruct
+ * The answer words packed and stored column by column, so a scoring kernel can load the same field of several answers
+ * at once. Arrays are padded up to a multiple of PACKED_BLOCK_SIZE with entries that score 0 against any guess.
+ * When several answers are the same word (like answers with letters blanked out), they can be stored once with a weight
+ * of how many answers they stand for.
+ */
+typedef struct packedAnswers packedAnswersStruct;
+struct packedAnswers{
+    unsigned int *letters[ PACKED_LETTER_WORDS];  // Letter codes of each answer
+    unsigned int *letterMasks[ MAX_WORD_LENGTH];  // Letter mask layers of each answer
+    unsigned int *weights;                        // How many answers each entry stands for, NULL if each is one
+    int count;                                    // Number of answers
+    int paddedCount;                              // Number of entries in each array, including the padding
+    int capacity;                                 // Number of entries there is room for
+    int maskLayers;                               // Number of mask layers that are not all zero
+    int wordLength;                               // Length of the answers
+    int letterWords;                              // Words of letter codes in use: 1, or 2 for long answers
+    unsigned int greenBits[ PACKED_LETTER_WORDS]; // Lowest bit of each letter code in use, per word of letter codes
+};
+
+/*
+ * Pack a word. Characters other than 'a'..'z' get the code blankCode and stay out of the masks, so they never match;
+ * answers and guesses use different blank codes so blanks never match each other either.
+ * Param: (const char[]) the word, (packedWordStruct*) packed word to fill in, (unsigned int) code for non-letters, (int)
+ * length of the word
+ */
+void packWord(const char word[], packedWordStruct *packed, unsigned int blankCode, int wordLength) {
+    int letterCounts[ 26] = {0};
+    int k = 0;
+    memset(packed, 0, sizeof(packedWordStruct));
+    for (k = 0; k < wordLength; k++) {
+        unsigned int code = blankCode;
+        if (word[k] >= 'a' && word[k] <= 'z') {
+            code = word[k] - 'a';
+            // the n-th copy of a letter goes into layer n-1
+            packed->letterMasks[letterCounts[code]] |= 1u << code;
+            letterCounts[code]++;
+        }
+        packed->letters[k / PACKED_CODES_PER_WORD] |= code << (LETTER_CODE_BITS * (k % PACKED_CODES_PER_WORD));
+    }
+}
+
+/*
+ * Number of letter mask layers of a packed word that are not all zero.
+ * Param: (const packedWordStruct*) packed word
+ * Output: 1 for a word without repeated letters, one more for every extra copy of its most repeated letter
+ */
+int packedMaskLayers(const packedWordStruct *packed) {
+    int layers = 0;
+    while (layers < MAX_WORD_LENGTH && packed->letterMasks[layers] != 0) {
+        layers++;
     }
-} //end compareFunction(..)
+    return layers;
+}
+
+/*
+ * All the letter codes of a packed word in one number, which tells words apart the same way the words themselves do.
+ * Param: (const packedWordStruct*) packed word
+ * Output: The letter codes, position 0 in the lowest bits
+ */
+unsigned long long packedWordKey(const packedWordStruct *packed) {
+    return packed->letters[0] | (unsigned long long)packed->letters[1] << (LETTER_CODE_BITS * PACKED_CODES_PER_WORD);
+}
+
+/*
+ * Turn the letter codes of packedWordKey(..) back into a word; codes other than letters become blanks.
+ * Param: (unsigned long long) letter codes, (char[]) room for the word and its NULL, (int) length of the word
+ */
+void unpackWordKey(unsigned long long key, char word[], int wordLength) {
+    int k = 0;
+    for (; k < wordLength; k++) {
+        unsigned int code = (unsigned int)(key >> (LETTER_CODE_BITS * k)) & 31;
+        word[k] = code < 26 ? (char)('a' + code) : ' ';
+    }
+    word[wordLength] = '\0';
+}
+
+/*
+ * Make room for packed answers, to be filled in with setPackedAnswer(..) and finishPackedAnswers(..). The room can be
+ * filled in again for another set of answers. Must be freed with freePackedAnswers(..).
+ * Param: (packedAnswersStruct*) the packed answers, (int) most answers they will hold, (int) length of the answers, (int)
+ * whether entries have weights
+ */
+void allocatePackedAnswers(packedAnswersStruct *answers, int capacity, int wordLength, int weighted) {
+    answers->capacity = (capacity + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE * PACKED_BLOCK_SIZE;
+    if (answers->capacity == 0) {
+        answers->capacity = PACKED_BLOCK_SIZE;
+    }
+    answers->count = 0;
+    answers->paddedCount = 0;
+    answers->maskLayers = 0;
+    answers->wordLength = wordLength;
+    answers->letterWords = (wordLength + PACKED_CODES_PER_WORD - 1) / PACKED_CODES_PER_WORD;
+    int w = 0;
+    for (; w < PACKED_LETTER_WORDS; w++) {
+        answers->letters[w] = (unsigned int *)malloc(sizeof(unsigned int) * answers->capacity);
+        answers->greenBits[w] = 0;
+    }
+    int k = 0;
+    for (; k < wordLength; k++) {
+        answers->greenBits[k / PACKED_CODES_PER_WORD] |= 1u << (LETTER_CODE_BITS * (k % PACKED_CODES_PER_WORD));
+    }
+    int layer = 0;
+    for (; layer < MAX_WORD_LENGTH; layer++) {
+        answers->letterMasks[layer] = (unsigned int *)malloc(sizeof(unsigned int) * answers->capacity);
+    }
+    answers->weights = weighted ? (unsigned int *)malloc(sizeof(unsigned int) * answers->capacity) : NULL;
+    STATS_COUNT(STATS_ALLOCATIONS, PACKED_LETTER_WORDS + MAX_WORD_LENGTH + (weighted ? 1 : 0));
+}
+
+/*
+ * Store one packed answer.
+ * Param: (packedAnswersStruct*) the packed answers, (int) position of the answer, (const packedWordStruct*) the packed
+ * answer word, (unsigned int) how many answers it stands for (ignored without weights)
+ */
+void setPackedAnswer(packedAnswersStruct *answers, int i, const packedWordStruct *packed, unsigned int weight) {
+    answers->letters[0][i] = packed->letters[0];
+    answers->letters[1][i] = packed->letters[1];
+    int layer = 0;
+    for (; layer < MAX_WORD_LENGTH; layer++) {
+        answers->letterMasks[layer][i] = packed->letterMasks[layer];
+    }
+    if (answers->weights != NULL) {
+        answers->weights[i] = weight;
+    }
+}
+
+/*
+ * Finish off packed answers once the first count of them are set: pad them for the scoring kernel and work out how
+ * many mask layers are in use.
+ * Param: (packedAnswersStruct*) the packed answers, (int) number of answers set
+ */
+void finishPackedAnswers(packedAnswersStruct *answers, int count) {
+    answers->count = count;
+    answers->paddedCount = (count + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE * PACKED_BLOCK_SIZE;
+    // padding: no letter code can match and no letters in common, so it scores 0
+    packedWordStruct padding;
+    memset(&padding, 0, sizeof(padding));
+    padding.letters[0] = PACKED_LETTERS_MASK;
+    padding.letters[1] = PACKED_LETTERS_MASK;
+    int i = count;
+    for (; i < answers->paddedCount; i++) {
+        setPackedAnswer(answers, i, &padding, 0);
+    }
+    answers->maskLayers = 0;
+    while (answers->maskLayers < answers->wordLength) {
+        unsigned int anyBits = 0;
+        for (i = 0; i < count; i++) {
+            anyBits |= answers->letterMasks[answers->maskLayers][i];
+        }
+        if (anyBits == 0) {
+            break;
+        }
+        answers->maskLayers++;
+    }
+}
+
+/*
+ * Pack an array of answer words for the scoring kernel. Must be freed with freePackedAnswers(..).
+ * Param: (packedAnswersStruct*) the packed answers to fill in, (wordCountStruct*) the answer words, (int) how many,
+ * (int) length of the words
+ */
+void packAnswers(packedAnswersStruct *answers, wordCountStruct *answerBegin, int answersCounter, int wordLength) {
+    allocatePackedAnswers(answers, answersCounter, wordLength, false);
+    int i = 0;
+    for (; i < answersCounter; i++) {
+        packedWordStruct packed;
+        packWord((answerBegin + i)->word, &packed, ANSWER_BLANK_CODE, wordLength);
+        setPackedAnswer(answers, i, &packed, 1);
+    }
+    finishPackedAnswers(answers, answersCounter);
+}
+
+void freePackedAnswers(packedAnswersStruct *answers) {
+    free(answers->letters[0]);
+    free(answers->letters[1]);
+    int layer = 0;
+    for (; layer < MAX_WORD_LENGTH; layer++) {
+        free(answers->letterMasks[layer]);
+    }
+    free(answers->weights);
+}
+
+#if defined(__AVX2__)
+/*
+ * Number of set bits in each byte of a vector, worked out with shifts and masks since there is no vector popcount.
+ */
+static inline __m256i byteBitCounts256(__m256i v) {
+    v = _mm256_sub_epi8(v, _mm256_and_si256(_mm256_srli_epi32(v, 1), _mm256_set1_epi8(0x55)));
+    v = _mm256_add_epi8(_mm256_and_si256(v, _mm256_set1_epi8(0x33)),
+                        _mm256_and_si256(_mm256_srli_epi32(v, 2), _mm256_set1_epi8(0x33)));
+    return _mm256_and_si256(_mm256_add_epi8(v, _mm256_srli_epi32(v, 4)), _mm256_set1_epi8(0x0F));
+}
+
+/*
+ * Per-byte contributions to the score of one guess against 8 answers starting at answer j: each green letter code counts
+ * twice and each shared letter mask bit once. Byte sums stay well below 256.
+ */
+static inline __m256i packedScoreBytes256(const packedAnswersStruct *answers, int j, const __m256i guessLetters[],
+                                          const __m256i greenBits[], const __m256i guessMasks[], int layers) {
+    __m256i bytes = _mm256_setzero_si256();
+    int w = 0;
+    for (; w < answers->letterWords; w++) {
+        __m256i x = _mm256_xor_si256(guessLetters[w], _mm256_loadu_si256((const __m256i *)(answers->letters[w] + j)));
+        // fold each 5 bit field into its lowest bit: that bit is 0 exactly when the letter codes are equal
+        __m256i folded = _mm256_or_si256(_mm256_or_si256(x, _mm256_srli_epi32(x, 1)),
+                                         _mm256_or_si256(_mm256_srli_epi32(x, 2), _mm256_srli_epi32(x, 3)));
+        folded = _mm256_or_si256(folded, _mm256_srli_epi32(x, 4));
+        __m256i greens = byteBitCounts256(_mm256_andnot_si256(folded, greenBits[w]));
+        bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(greens, greens));
+    }
+    int layer = 0;
+    for (; layer < layers; layer++) {
+        __m256i shared = _mm256_and_si256(guessMasks[layer],
+                                          _mm256_loadu_si256((const __m256i *)(answers->letterMasks[layer] + j)));
+        bytes = _mm256_add_epi8(bytes, byteBitCounts256(shared));
+    }
+    return bytes;
+}
+
+/*
+ * Weighted scores of one guess against 8 answers starting at answer j, as 32 bit lanes.
+ */
+static inline __m256i packedWeightedScores256(const packedAnswersStruct *answers, int j, const __m256i guessLetters[],
+                                              const __m256i greenBits[], const __m256i guessMasks[], int layers) {
+    __m256i bytes = packedScoreBytes256(answers, j, guessLetters, greenBits, guessMasks, layers);
+    // add up the 4 bytes of each answer's lane
+    bytes = _mm256_add_epi32(bytes, _mm256_srli_epi32(bytes, 8));
+    bytes = _mm256_add_epi32(bytes, _mm256_srli_epi32(bytes, 16));
+    __m256i scores = _mm256_and_si256(bytes, _mm256_set1_epi32(0xFF));
+    return _mm256_mullo_epi32(scores, _mm256_loadu_si256((const __m256i *)(answers->weights + j)));
+}
+#elif defined(__SSE2__)
+/*
+ * Number of set bits in each byte of a vector, worked out with shifts and masks since there is no vector popcount.
+ */
+static inline __m128i byteBitCounts128(__m128i v) {
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi32(v, 1), _mm_set1_epi8(0x55)));
+    v = _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x33)), _mm_and_si128(_mm_srli_epi32(v, 2), _mm_set1_epi8(0x33)));
+    return _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi32(v, 4)), _mm_set1_epi8(0x0F));
+}
+
+/*
+ * Per-byte contributions to the score of one guess against 4 answers starting at answer j: each green letter code counts
+ * twice and each shared letter mask bit once. Byte sums stay well below 256.
+ */
+static inline __m128i packedScoreBytes128(const packedAnswersStruct *answers, int j, const __m128i guessLetters[],
+                                          const __m128i greenBits[], const __m128i guessMasks[], int layers) {
+    __m128i bytes = _mm_setzero_si128();
+    int w = 0;
+    for (; w < answers->letterWords; w++) {
+        __m128i x = _mm_xor_si128(guessLetters[w], _mm_loadu_si128((const __m128i *)(answers->letters[w] + j)));
+        // fold each 5 bit field into its lowest bit: that bit is 0 exactly when the letter codes are equal
+        __m128i folded = _mm_or_si128(_mm_or_si128(x, _mm_srli_epi32(x, 1)),
+                                      _mm_or_si128(_mm_srli_epi32(x, 2), _mm_srli_epi32(x, 3)));
+        folded = _mm_or_si128(folded, _mm_srli_epi32(x, 4));
+        __m128i greens = byteBitCounts128(_mm_andnot_si128(folded, greenBits[w]));
+        bytes = _mm_add_epi8(bytes, _mm_add_epi8(greens, greens));
+    }
+    int layer = 0;
+    for (; layer < layers; layer++) {
+        __m128i shared = _mm_and_si128(guessMasks[layer], _mm_loadu_si128((const __m128i *)(answers->letterMasks[layer] + j)));
+        bytes = _mm_add_epi8(bytes, byteBitCounts128(shared));
+    }
+    return bytes;
+}
+
+/*
+ * Weighted scores of one guess against 4 answers starting at answer j, as 32 bit lanes. SSE2 has no 32 bit multiply,
+ * but scores and weights both fit in 15 bits, so a 16 bit multiply-add of each lane with the weight gives the product.
+ */
+static inline __m128i packedWeightedScores128(const packedAnswersStruct *answers, int j, const __m128i guessLetters[],
+                                              const __m128i greenBits[], const __m128i guessMasks[], int layers) {
+    __m128i bytes = packedScoreBytes128(answers, j, guessLetters, greenBits, guessMasks, layers);
+    // add up the 4 bytes of each answer's lane
+    bytes = _mm_add_epi32(bytes, _mm_srli_epi32(bytes, 8));
+    bytes = _mm_add_epi32(bytes, _mm_srli_epi32(bytes, 16));
+    __m128i scores = _mm_and_si128(bytes, _mm_set1_epi32(0xFF));
+    return _mm_madd_epi16(scores, _mm_loadu_si128((const __m128i *)(answers->weights + j)));
+}
+#endif
+
+/*
+ * Weighted version of packedScoreCompute(..): each answer's score counts as many times as its weight.
+ * Param: (const packedWordStruct*) the packed guess word, (const packedAnswersStruct*) the packed answer words, with
+ * weights, (int) number of mask layers to compare
+ * Output: Total score of the guess
+ */
+long long packedWeightedScoreCompute(const packedWordStruct *guess, const packedAnswersStruct *answers, int layers) {
+    int layer = 0;
+    int j = 0;
+#if defined(__AVX2__)
+    __m256i guessLetters[ PACKED_LETTER_WORDS];
+    __m256i greenBits[ PACKED_LETTER_WORDS];
+    int w = 0;
+    for (; w < PACKED_LETTER_WORDS; w++) {
+        guessLetters[w] = _mm256_set1_epi32((int)guess->letters[w]);
+        greenBits[w] = _mm256_set1_epi32((int)answers->greenBits[w]);
+    }
+    __m256i guessMasks[ MAX_WORD_LENGTH];
+    for (; layer < layers; layer++) {
+        guessMasks[layer] = _mm256_set1_epi32((int)guess->letterMasks[layer]);
+    }
+    __m256i total = _mm256_setzero_si256();
+    for (; j < answers->paddedCount; j += 32) {
+        __m256i sum = packedWeightedScores256(answers, j, guessLetters, greenBits, guessMasks, layers);
+        sum = _mm256_add_epi32(sum, packedWeightedScores256(answers, j + 8, guessLetters, greenBits, guessMasks, layers));
+        sum = _mm256_add_epi32(sum, packedWeightedScores256(answers, j + 16, guessLetters, greenBits, guessMasks,
+                                                            layers));
+        sum = _mm256_add_epi32(sum, packedWeightedScores256(answers, j + 24, guessLetters, greenBits, guessMasks,
+                                                            layers));
+        total = _mm256_add_epi32(total, sum);
+    }
+    int lanes[ 8];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    return (long long)lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+#elif defined(__SSE2__)
+    __m128i guessLetters[ PACKED_LETTER_WORDS];
+    __m128i greenBits[ PACKED_LETTER_WORDS];
+    int w = 0;
+    for (; w < PACKED_LETTER_WORDS; w++) {
+        guessLetters[w] = _mm_set1_epi32((int)guess->letters[w]);
+        greenBits[w] = _mm_set1_epi32((int)answers->greenBits[w]);
+    }
+    __m128i guessMasks[ MAX_WORD_LENGTH];
+    for (; layer < layers; layer++) {
+        guessMasks[layer] = _mm_set1_epi32((int)guess->letterMasks[layer]);
+    }
+    __m128i total = _mm_setzero_si128();
+    for (; j < answers->paddedCount; j += 8) {
+        total = _mm_add_epi32(total, packedWeightedScores128(answers, j, guessLetters, greenBits, guessMasks, layers));
+        total = _mm_add_epi32(total, packedWeightedScores128(answers, j + 4, guessLetters, greenBits, guessMasks, layers));
+    }
+    int lanes[ 4];
+    _mm_storeu_si128((__m128i *)lanes, total);
+    return (long long)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    long long total = 0;
+    for (; j < answers->count; j++) {
+        int score = 0;
+        int w = 0;
+        for (; w < answers->letterWords; w++) {
+            unsigned int x = guess->letters[w] ^ answers->letters[w][j];
+            unsigned int folded = x | (x >> 1) | (x >> 2) | (x >> 3) | (x >> 4);
+            score += 2 * __builtin_popcount(~folded & answers->greenBits[w]);
+        }
+        for (layer = 0; layer < layers; layer++) {
+            score += __builtin_popcount(guess->letterMasks[layer] & answers->letterMasks[layer][j]);
+        }
+        total += (long long)score * answers->weights[j];
+    }
+    return total;
+#endif
+}
+
+/*
+ * Scoring kernel: the sum of the 3/1 point scores of one packed guess against all the packed answers, equal to adding up
+ * scoreAssigning(..) over every answer (weighted answers counting as many times as their weight). Uses AVX2 (32 answers per loop) or SSE2 (8 answers per loop) when the compiler
+ * targets them, and plain bit operations otherwise.
+ * Param: (const packedWordStruct*) the packed guess word, (const packedAnswersStruct*) the packed answer words
+ * Output: Total score of the guess
+ */
+int packedScoreCompute(const packedWordStruct *guess, const packedAnswersStruct *answers) {
+    // letters a word has more copies of than the guess can not be matched more times than the guess has them
+    int layers = packedMaskLayers(guess);
+    if (layers > answers->maskLayers) {
+        layers = answers->maskLayers;
+    }
+    if (answers->weights != NULL) {
+        return (int)packedWeightedScoreCompute(guess, answers, layers);
+    }
+    int layer = 0;
+    int j = 0;
+#if defined(__AVX2__)
+    __m256i guessLetters[ PACKED_LETTER_WORDS];
+    __m256i greenBits[ PACKED_LETTER_WORDS];
+    int w = 0;
+    for (; w < PACKED_LETTER_WORDS; w++) {
+        guessLetters[w] = _mm256_set1_epi32((int)guess->letters[w]);
+        greenBits[w] = _mm256_set1_epi32((int)answers->greenBits[w]);
+    }
+    __m256i guessMasks[ MAX_WORD_LENGTH];
+    for (; layer < layers; layer++) {
+        guessMasks[layer] = _mm256_set1_epi32((int)guess->letterMasks[layer]);
+    }
+    __m256i total = _mm256_setzero_si256();
+    for (; j < answers->paddedCount; j += 32) {
+        __m256i bytes = packedScoreBytes256(answers, j, guessLetters, greenBits, guessMasks, layers);
+        bytes = _mm256_add_epi8(bytes, packedScoreBytes256(answers, j + 8, guessLetters, greenBits, guessMasks, layers));
+        __m256i moreBytes = packedScoreBytes256(answers, j + 16, guessLetters, greenBits, guessMasks, layers);
+        moreBytes = _mm256_add_epi8(moreBytes, packedScoreBytes256(answers, j + 24, guessLetters, greenBits, guessMasks,
+                                                                   layers));
+        // sum up the bytes into the four 64 bit lanes
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(moreBytes, _mm256_setzero_si256()));
+    }
+    long long lanes[ 4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    return (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+    __m128i guessLetters[ PACKED_LETTER_WORDS];
+    __m128i greenBits[ PACKED_LETTER_WORDS];
+    int w = 0;
+    for (; w < PACKED_LETTER_WORDS; w++) {
+        guessLetters[w] = _mm_set1_epi32((int)guess->letters[w]);
+        greenBits[w] = _mm_set1_epi32((int)answers->greenBits[w]);
+    }
+    __m128i guessMasks[ MAX_WORD_LENGTH];
+    for (; layer < layers; layer++) {
+        guessMasks[layer] = _mm_set1_epi32((int)guess->letterMasks[layer]);
+    }
+    __m128i total = _mm_setzero_si128();
+    for (; j < answers->paddedCount; j += 8) {
+        __m128i bytes = packedScoreBytes128(answers, j, guessLetters, greenBits, guessMasks, layers);
+        bytes = _mm_add_epi8(bytes, packedScoreBytes128(answers, j + 4, guessLetters, greenBits, guessMasks, layers));
+        // sum up the bytes into the two 64 bit lanes
+        total = _mm_add_epi64(total, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+    }
+    long long lanes[ 2];
+    _mm_storeu_si128((__m128i *)lanes, total);
+    return (int)(lanes[0] + lanes[1]);
+#else
+    int total = 0;
+    for (; j < answers->count; j++) {
+        int w = 0;
+        for (; w < answers->letterWords; w++) {
+            unsigned int x = guess->letters[w] ^ answers->letters[w][j];
+            unsigned int folded = x | (x >> 1) | (x >> 2) | (x >> 3) | (x >> 4);
+            total += 2 * __builtin_popcount(~folded & answers->greenBits[w]);
+        }
+        for (layer = 0; layer < layers; layer++) {
+            total += __builtin_popcount(guess->letterMasks[layer] & answers->letterMasks[layer][j]);
+        }
+    }
+    return total;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------
+// Loading words.  A words file is memory-mapped and parsed in a single pass, growing the
+// array of words as needed.  The first word sets the word length of the dictionary, and
+// tokens that are not words of that length are reported and skipped.  Optionally the words
+// are also saved to a binary word cache next to the words file (its name with
+// WORD_CACHE_SUFFIX added), holding the letters of each word, the size and modification
+// time of the words file and a hash of the letters.  On the next run the cache is used if
+// the size and modification time still match, without mapping or reading the words file;
+// a cache whose letters do not hash the same or are not all 'a'..'z' is parsed again.
+// Only the size and modification time of the words file are checked, so a file changed
+// without changing either (copied with cp -p, or touch -r) needs its cache deleted.  The
+// cache holds letters rather than packed words, since the words are handed back as
+// wordCountStruct like a parse would, and packing them again is a few shifts per word.
+
+/*
+ * struct: wordCacheHeaderStruct
+ * Start of a word cache file, followed by the wordLength letters of each word in file order, already lowercase.
+ */
+typedef struct wordCacheHeader wordCacheHeaderStruct;
+struct wordCacheHeader{
+    char magic[ 8];                 // WORD_CACHE_MAGIC
+    unsigned int version;           // WORD_CACHE_VERSION
+    unsigned int wordLength;        // Length of the words
+    unsigned int wordCount;         // Number of words
+    unsigned int reserved;          // Always 0
+    long long fileSize;             // Size of the words file the cache was made from
+    long long fileModified;         // Modification time of the words file, in nanoseconds
+    unsigned long long contentHash; // Hash of the letters that follow
+};
+
+/*
+ * 64 bit FNV-1a hash of a block of memory, used to tell whether a file changed.
+ * Param: (const char*) the memory, (size_t) its size in bytes, (unsigned long long) hash to continue from, or
+ * FNV_OFFSET_BASIS to start a new one
+ * Output: The hash
+ */
+unsigned long long contentHash(const char *contents, size_t size, unsigned long long hash) {
+    size_t i = 0;
+    for (; i < size; i++) {
+        hash = (hash ^ (unsigned char)contents[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/*
+ * Make room for more words at the end of a dynamically allocated array of words, doubling its capacity when it is full.
+ * Param: (wordCountStruct**) the array passed by reference, (int*) its capacity passed by reference, (int) number of
+ * words it holds
+ */
+void growWordArray(wordCountStruct **words, int *capacity, int wordCount) {
+    if (wordCount < *capacity) {
+        return;
+    }
+    *capacity = *capacity < 1024 ? 1024 : *capacity * 2;
+    wordCountStruct *grown = (wordCountStruct *)realloc(*words, sizeof(wordCountStruct) * *capacity);
+    STATS_COUNT(STATS_ALLOCATIONS, 1);
+    if (grown == NULL) {
+        fprintf(stderr, "Not enough memory for %d words. Exiting...\n", *capacity);
+        exit(-1);
+    }
+    *words = grown;
+}
+
+/*
+ * Parse the words of a words file in one pass and add them to the end of an array. Letters are turned to lowercase;
+ * tokens that are not words of the dictionary's length are reported and skipped.
+ * Param: (const char*) contents of the file, (size_t) size of the contents, (char[]) file name for messages,
+ * (wordCountStruct**) array of words passed by reference, holding exactly *wordCount words, (int*) number of words,
+ * (int*) length of the words, 0 until the first word sets it
+ */
+void parseWords(const char *contents, size_t size, char fileName[], wordCountStruct **words, int *wordCount,
+                int *wordLength) {
+    int capacity = *wordCount;
+    int invalidCount = 0;
+    int lineNumber = 1;
+    size_t position = 0;
+    while (position < size) {
+        if (isspace((unsigned char)contents[position])) {
+            if (contents[position] == '\n') {
+                lineNumber++;
+            }
+            position++;
+            continue;
+        }
+        // the token runs until the next white space
+        size_t start = position;
+        while (position < size && !isspace((unsigned char)contents[position])) {
+            position++;
+        }
+        int length = (int)(position - start);
+        int valid = *wordLength == 0 ? length >= MIN_WORD_LENGTH && length <= MAX_WORD_LENGTH : length == *wordLength;
+        int k = 0;
+        for (; valid && k < length; k++) {
+            valid = isalpha((unsigned char)contents[start + k]);
+        }
+        if (!valid) {
+            invalidCount++;
+            if (invalidCount <= MAX_INVALID_WORDS_SHOWN && *wordLength == 0) {
+                fprintf(stderr, "Skipping \"%.*s\" on line %d of %s, it is not a word of %d to %d letters.\n",
+                               length < 20 ? length : 20, contents + start, lineNumber, fileName, MIN_WORD_LENGTH,
+                               MAX_WORD_LENGTH);
+            }
+            else if (invalidCount <= MAX_INVALID_WORDS_SHOWN) {
+                fprintf(stderr, "Skipping \"%.*s\" on line %d of %s, it is not a %d letter word.\n",
+                               length < 20 ? length : 20, contents + start, lineNumber, fileName, *wordLength);
+            }
+            continue;
+        }
+        *wordLength = length;
+        growWordArray(words, &capacity, *wordCount);
+        wordCountStruct *word = *words + *wordCount;
+        for (k = 0; k < length; k++) {
+            word->word[k] = (char)tolower((unsigned char)contents[start + k]);
+        }
+        word->word[length] = '\0';
+        word->score = 0;
+        word->index = *wordCount;
+        (*wordCount)++;
+    }
+    if (invalidCount > MAX_INVALID_WORDS_SHOWN) {
+        fprintf(stderr, "Skipped %d tokens of %s in total.\n", invalidCount, fileName);
+    }
+    // give back the room that was not needed
+    if (*wordCount > 0 && *wordCount < capacity) {
+        *words = (wordCountStruct *)realloc(*words, sizeof(wordCountStruct) * *wordCount);
+    }
+}
+
+/*
+ * Modification time of a file in nanoseconds, part of the key of its word cache.
+ */
+long long fileModifiedNanoseconds(const struct stat *fileStatus) {
+    return (long long)fileStatus->st_mtim.tv_sec * 1000000000LL + fileStatus->st_mtim.tv_nsec;
+}
+
+/*
+ * Add the words of a word cache to the end of an array, if the cache is there and was made from the words file as it
+ * is now. The whole cache is checked before any word is added: its size, the hash of its letters and every letter.
+ * Param: (char[]) word cache file name, (const struct stat*) status of the words file, (wordCountStruct**) array of
+ * words passed by reference, holding exactly *wordCount words, (int*) number of words, (int*) length of the words, 0
+ * if no words were read yet
+ * Output: true if the words came from the cache, false if the cache is missing, out of date or damaged
+ */
+int readWordCache(char cacheFileName[], const struct stat *wordsFileStatus, wordCountStruct **words, int *wordCount,
+                  int *wordLength) {
+    FILE *cacheFilePtr = fopen(cacheFileName, "rb");
+    if (cacheFilePtr == NULL) {
+        return false;
+    }
+    wordCacheHeaderStruct header;
+    struct stat cacheStatus;
+    if (fread(&header, sizeof(header), 1, cacheFilePtr) != 1 || memcmp(header.magic, WORD_CACHE_MAGIC, 8) != 0
+        || header.version != WORD_CACHE_VERSION || header.fileSize != (long long)wordsFileStatus->st_size
+        || header.fileModified != fileModifiedNanoseconds(wordsFileStatus)
+        || header.wordLength < MIN_WORD_LENGTH || header.wordLength > MAX_WORD_LENGTH
+        || (*wordLength != 0 && header.wordLength != (unsigned int)*wordLength)
+        || header.wordCount > (unsigned int)(INT_MAX - *wordCount - 1)
+        || fstat(fileno(cacheFilePtr), &cacheStatus) != 0
+        || (size_t)cacheStatus.st_size != sizeof(header) + (size_t)header.wordCount * header.wordLength) {
+        fclose(cacheFilePtr);
+        return false;
+    }
+    size_t letterCount = (size_t)header.wordCount * header.wordLength;
+    char *letters = (char *)malloc(letterCount + 1);
+    int valid = letters != NULL && fread(letters, 1, letterCount, cacheFilePtr) == letterCount
+                && contentHash(letters, letterCount, FNV_OFFSET_BASIS) == header.contentHash;
+    fclose(cacheFilePtr);
+    size_t k = 0;
+    for (; valid && k < letterCount; k++) {
+        valid = letters[k] >= 'a' && letters[k] <= 'z';
+    }
+    wordCountStruct *grown = NULL;
+    if (valid) {
+        grown = (wordCountStruct *)realloc(*words, sizeof(wordCountStruct) * ((size_t)*wordCount + header.wordCount + 1));
+        STATS_COUNT(STATS_ALLOCATIONS, 1);
+    }
+    if (grown == NULL) {
+        free(letters);
+        return false;
+    }
+    *words = grown;
+    *wordLength = (int)header.wordLength;
+    unsigned int i = 0;
+    for (; i < header.wordCount; i++) {
+        wordCountStruct *word = *words + *wordCount;
+        memcpy(word->word, letters + (size_t)i * header.wordLength, header.wordLength);
+        word->word[header.wordLength] = '\0';
+        word->score = 0;
+        word->index = *wordCount;
+        (*wordCount)++;
+    }
+    free(letters);
+    return true;
+}
+
+/*
+ * Save words to a word cache. Failing to write the cache only costs the time it would have saved, so it is not an error.
+ * Param: (char[]) word cache file name, (const struct stat*) status of the words file, (wordCountStruct*) the words of
+ * the file, (int) how many, (int) length of the words
+ */
+void writeWordCache(char cacheFileName[], const struct stat *wordsFileStatus, wordCountStruct *words, int wordCount,
+                    int wordLength) {
+    FILE *cacheFilePtr = fopen(cacheFileName, "wb");
+    if (cacheFilePtr == NULL) {
+        fprintf(stderr, "Could not write word cache %s.\n", cacheFileName);
+        return;
+    }
+    wordCacheHeaderStruct header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORD_CACHE_MAGIC, 8);
+    header.version = WORD_CACHE_VERSION;
+    header.wordLength = wordLength;
+    header.wordCount = wordCount;
+    header.fileSize = (long long)wordsFileStatus->st_size;
+    header.fileModified = fileModifiedNanoseconds(wordsFileStatus);
+    header.contentHash = FNV_OFFSET_BASIS;
+    int i = 0;
+    for (; i < wordCount; i++) {
+        header.contentHash = contentHash((words + i)->word, wordLength, header.contentHash);
+    }
+    int written = fwrite(&header, sizeof(header), 1, cacheFilePtr) == 1;
+    for (i = 0; written && i < wordCount; i++) {
+        written = fwrite((words + i)->word, 1, wordLength, cacheFilePtr) == (size_t)wordLength;
+    }
+    if (fclose(cacheFilePtr) != 0 || !written) {
+        remove(cacheFileName);
+        fprintf(stderr, "Could not write word cache %s.\n", cacheFileName);
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+// Read in words from file into a dynamically allocated array, adding them after the words
+// already in it, so a second file can be read in after the first.
+void readWordsFromFile(
+        char fileName[],          // Filename we'll read from
+        wordCountStruct **words,  // Array of words where we'll store words we read from file, grown as needed (NULL to start a new one)
+        int *wordCount,           // How many words are in the array.  Gets updated here and returned
+        int *wordLength,          // Length of the words, 0 to take it from the first word.  Gets updated here and returned
+        int useWordCache)         // Whether to use and update the word cache of the file
+{
+    STATS_START(timer);
+    int fileDescriptor = open(fileName, O_RDONLY);   // Connect logical name to filename
+    struct stat fileStatus;
+    if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStatus) != 0) {
+        fprintf(stderr, "Could not open words file %s. Exiting...\n", fileName);
+        exit(-1);
+    }
+    // the word cache is keyed on the size and modification time, so a hit never reads the words file itself
+    char cacheFileName[ 1024];
+    snprintf(cacheFileName, sizeof(cacheFileName), "%s%s", fileName, WORD_CACHE_SUFFIX);
+    if (useWordCache && readWordCache(cacheFileName, &fileStatus, words, wordCount, wordLength)) {
+        close(fileDescriptor);
+        STATS_STOP(timer, STATS_LOAD);
+        return;
+    }
+    size_t size = (size_t)fileStatus.st_size;
+    const char *contents = "";
+    if (size > 0) {
+        contents = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (contents == MAP_FAILED) {
+            fprintf(stderr, "Could not map words file %s. Exiting...\n", fileName);
+            exit(-1);
+        }
+    }
+    int firstWord = *wordCount;
+    parseWords(contents, size, fileName, words, wordCount, wordLength);
+    if (useWordCache && *wordLength != 0) {
+        writeWordCache(cacheFileName, &fileStatus, *words + firstWord, *wordCount - firstWord, *wordLength);
+    }
+
+    // Close the file
+    if (size > 0) {
+        munmap((void *)contents, size);
+    }
+    close(fileDescriptor);
+    STATS_STOP(timer, STATS_LOAD);
+} // end readWordsFromFile(..)
+
+//-----------------------------------------------------------------------------------------
+// Word store.  The words being scored for the best first and second words are kept as a
+// structure of arrays instead of an array of wordCountStruct: the letters back to back, the
+// words packed as guesses once, and the scores in an array of their own.
+// Scoring streams through the packed words and writes only the scores, selecting the best
+// words reads only the scores, and sorting moves word indexes instead of whole words.
+
+/*
+ * struct: wordStoreStruct
+ * The words of a report, word i at index i of every array, answer words first.
+ */
+typedef struct wordStore wordStoreStruct;
+struct wordStore{
+    char *letters;              // wordLength letters per word, back to back, without a NULL between them
+    packedWordStruct *packed;   // Each word packed as a guess, for the scoring kernel
+    int *scores;                // Score of each word
+    int count;                  // Number of words
+    int wordLength;             // Length of the words
+};
+
+/*
+ * Build a word store out of words read in. Must be freed with freeWordStore(..).
+ * Param: (wordStoreStruct*) the store, (const wordCountStruct*) the words, (int) how many, (int) length of the words
+ */
+void initializeWordStore(wordStoreStruct *store, const wordCountStruct *words, int wordCount, int wordLength) {
+    store->count = wordCount;
+    store->wordLength = wordLength;
+    store->letters = (char *)malloc((size_t)wordLength * (wordCount > 0 ? wordCount : 1));
+    store->packed = (packedWordStruct *)malloc(sizeof(packedWordStruct) * (wordCount > 0 ? wordCount : 1));
+    store->scores = (int *)calloc(wordCount > 0 ? wordCount : 1, sizeof(int));
+    int i = 0;
+    for (; i < wordCount; i++) {
+        memcpy(store->letters + (size_t)i * wordLength, (words + i)->word, wordLength);
+        packWord((words + i)->word, store->packed + i, GUESS_BLANK_CODE, wordLength);
+    }
+}
+
+void freeWordStore(wordStoreStruct *store) {
+    free(store->letters);
+    free(store->packed);
+    free(store->scores);
+}
+
+/*
+ * Letters of a word of the store, not NULL terminated: print them with "%.*s" and the word length.
+ */
+const char *storedWord(const wordStoreStruct *store, int i) {
+    return store->letters + (size_t)i * store->wordLength;
+}
+
+/*
+ * Order of words of a store given by their index: descending by score, then alphabetical.
+ */
+int compareStoredWords(const wordStoreStruct *store, int a, int b) {
+    STATS_COUNT_PENDING(STATS_COMPARISONS, 1);
+    if (store->scores[a] != store->scores[b]) {
+        return store->scores[b] - store->scores[a];
+    }
+    // all words have the same length, so comparing their letters puts them in alphabetical order
+    return memcmp(storedWord(store, a), storedWord(store, b), store->wordLength);
+}
+
+/*
+ * Move a word down a heap of word indexes until neither of its children sorts after it by compareStoredWords(..), so
+ * the word that sorts last is always on top.
+ * Param: (const wordStoreStruct*) the store, (int[]) the heap, (int) number of words in it, (int) position of the word
+ * to move down
+ */
+void siftDownWordHeap(const wordStoreStruct *store, int heap[], int heapSize, int position) {
+    while (true) {
+        int last = position;
+        int child = 2 * position + 1;
+        if (child < heapSize && compareStoredWords(store, heap[child], heap[last]) > 0) {
+            last = child;
+        }
+        if (child + 1 < heapSize && compareStoredWords(store, heap[child + 1], heap[last]) > 0) {
+            last = child + 1;
+        }
+        if (last == position) {
+            return;
+        }
+        int swap = heap[position];
+        heap[position] = heap[last];
+        heap[last] = swap;
+        position = last;
+    }
+}
+
+/*
+ * Sort word indexes of a store by compareStoredWords(..), with a heap sort that takes the store as an argument, so
+ * words of different stores can be sorted on several threads at the same time.
+ * Param: (const wordStoreStruct*) the store, (int[]) the word indexes, (int) how many
+ */
+void sortStoredWords(const wordStoreStruct *store, int indexes[], int count) {
+    STATS_START(timer);
+    int position = count / 2 - 1;
+    for (; position >= 0; position--) {
+        siftDownWordHeap(store, indexes, count, position);
+    }
+    // the word that sorts last is on top, move it behind the heap
+    int heapSize = count - 1;
+    for (; heapSize > 0; heapSize--) {
+        int swap = indexes[0];
+        indexes[0] = indexes[heapSize];
+        indexes[heapSize] = swap;
+        siftDownWordHeap(store, indexes, heapSize, 0);
+    }
+    // the comparisons of selections before the sort are added here too
+    STATS_FLUSH(STATS_COMPARISONS);
+    STATS_STOP(timer, STATS_SORT);
+}
+
+/*
+ * Find the words tied for the highest score in one pass over the scores, instead of sorting all the words.
+ * Param: (const wordStoreStruct*) the store, with scores, (int) how many words, from the first, to look at,
+ * (scratchArenaStruct*) arena to take the result from, (int*) number of tied words, returned by reference
+ * Output: Indexes of the tied words in alphabetical order, from the arena, NULL if there are no words.
+ */
+int *selectHighestScoredWords(const wordStoreStruct *store, int size, scratchArenaStruct *arena, int *tieCount) {
+    *tieCount = 0;
+    int highestScore = 0;
+    int i = 0;
+    for (; i < size; i++) {
+        if (*tieCount == 0 || store->scores[i] > highestScore) {
+            highestScore = store->scores[i];
+            *tieCount = 0;
+        }
+        if (store->scores[i] == highestScore) {
+            (*tieCount)++;
+        }
+    }
+    if (*tieCount == 0) {
+        return NULL;
+    }
+    int *tiedWords = (int *)arenaAllocate(arena, sizeof(int) * *tieCount);
+    int tied = 0;
+    for (i = 0; i < size; i++) {
+        if (store->scores[i] == highestScore) {
+            tiedWords[tied++] = i;
+        }
+    }
+    // all scores are the same, so this puts them in alphabetical order
+    sortStoredWords(store, tiedWords, *tieCount);
+    return tiedWords;
+}
+
+/*
+ * Select the k words that come first in compareStoredWords(..) order (highest score, then alphabetical) in one pass
+ * over the scores, keeping the best k seen so far in a heap with the worst of them on top.
+ * Param: (const wordStoreStruct*) the store, with scores, (int) how many words, from the first, to look at, (int) k,
+ * (int[]) array with room for k word indexes to fill in
+ * Output: Number of words selected (k, or fewer if there are not that many words), sorted the same as
+ * compareStoredWords(..)
+ */
+int selectTopWords(const wordStoreStruct *store, int size, int k, int topWords[]) {
+    int heapSize = 0;
+    int i = 0;
+    for (; i < size && k > 0; i++) {
+        if (heapSize < k) {
+            // add at the bottom and move it up until its parent sorts after it
+            int position = heapSize++;
+            topWords[position] = i;
+            while (position > 0 && compareStoredWords(store, topWords[(position - 1) / 2], topWords[position]) < 0) {
+                int swap = topWords[position];
+                topWords[position] = topWords[(position - 1) / 2];
+                topWords[(position - 1) / 2] = swap;
+                position = (position - 1) / 2;
+            }
+        }
+        else if (compareStoredWords(store, i, topWords[0]) < 0) {
+            // better than the worst of the best k so far, so it takes its place
+            topWords[0] = i;
+            siftDownWordHeap(store, topWords, heapSize, 0);
+        }
+    }
+    sortStoredWords(store, topWords, heapSize);
+    return heapSize;
+}
+
+/*
+ * Pack the first answersCounter words of a store as answers for the scoring kernel. Must be freed with
+ * freePackedAnswers(..).
+ * Param: (packedAnswersStruct*) the packed answers to fill in, (const wordStoreStruct*) the store, (int) how many
+ * answer words it starts with
+ */
+void packStoredAnswers(packedAnswersStruct *answers, const wordStoreStruct *store, int answersCounter) {
+    allocatePackedAnswers(answers, answersCounter, store->wordLength, false);
+    int i = 0;
+    for (; i < answersCounter; i++) {
+        packedWordStruct packed;
+        packWord(storedWord(store, i), &packed, ANSWER_BLANK_CODE, store->wordLength);
+        setPackedAnswer(answers, i, &packed, 1);
+    }
+    finishPackedAnswers(answers, answersCounter);
+}
+
+//-----------------------------------------------------------------------------------------
+// Scoring.  Every word of a word store is scored against the packed answer words on the
+// worker pool, and for the second words against the answers with the letters of a first
+// word blanked out.  For very large dictionaries the words can also be split into shards,
+// each scored by a forked process (with a worker pool of its own) into shared memory, and
+// the shards' scores merged back into the store, giving the same scores and rankings as
+// scoring them all in one process.
+
+/*
+ * struct: scoreJobStruct
+ * Data shared by the worker pool threads while scoring guesses: the packed guesses, where their scores go and the packed
+ * answers. Each thread only writes the scores of its own words.
+ */
+typedef struct scoreJob scoreJobStruct;
+struct scoreJob{
+    const packedWordStruct *guesses;           // Words to have their scores computed, packed as guesses
+    int *scores;                               // Output: score of each word
+    const packedAnswersStruct *packedAnswers;  // Answers to score the words against
+};
+
+/*
+ * Worker pool job: compute the scores of the words from begin to end - 1 of a scoreJobStruct.
+ */
+void scoreComputeRange(void *context, int begin, int end) {
+    scoreJobStruct *scoreJob = (scoreJobStruct *)context;
+    int i = begin;
+    for (; i < end; i++) {
+        // score of a word is defined to be the sum of all its scores relative to the answerWord.
+        scoreJob->scores[i] = packedScoreCompute(scoreJob->guesses + i, scoreJob->packedAnswers);
+    }
+}
+
+/*
+ * Score the words of a store in shards, each in a forked process writing its scores to memory shared with this one,
+ * then merge the scores of all shards into the store. The children get copies of the store and the answers from the
+ * fork, and only send back their scores.
+ * Param: (wordStoreStruct*) the store of the words to score, (const packedAnswersStruct*) the packed answers, (int)
+ * amount of words to have scores computed, from the first, (int) number of shards, (workerPoolStruct*) worker pool,
+ * for the number of threads each shard scores with, or NULL for one
+ */
+void scoreShardedCompute(wordStoreStruct *store, const packedAnswersStruct *packedAnswers, int size, int shardCount,
+                         workerPoolStruct *pool) {
+    size_t scoresSize = sizeof(int) * (size > 0 ? size : 1);
+    int *sharedScores = (int *)mmap(NULL, scoresSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (sharedScores == MAP_FAILED) {
+        printf("Could not map memory for the scores of %d shards. Exiting...\n", shardCount);
+        exit(-1);
+    }
+    // anything still buffered would otherwise be written once by every child as well
+    fflush(stdout);
+    fflush(stderr);
+    pid_t *shards = (pid_t *)malloc(sizeof(pid_t) * shardCount);
+    int shard = 0;
+    for (; shard < shardCount; shard++) {
+        int begin = (int)((long long)size * shard / shardCount);
+        int end = (int)((long long)size * (shard + 1) / shardCount);
+        shards[shard] = fork();
+        if (shards[shard] < 0) {
+            printf("Could not start scoring shard %d. Exiting...\n", shard);
+            exit(-1);
+        }
+        if (shards[shard] == 0) {
+            // only the forking thread is copied, so the shard starts threads of its own
+            workerPoolStruct *shardPool = createWorkerPool(pool != NULL ? pool->threadCount : 1);
+            scoreJobStruct scoreJob;
+            scoreJob.guesses = store->packed + begin;
+            scoreJob.scores = sharedScores + begin;
+            scoreJob.packedAnswers = packedAnswers;
+            workerPoolRun(shardPool, scoreComputeRange, &scoreJob, end - begin, SCORE_CHUNK_SIZE);
+            freeWorkerPool(shardPool);
+            // leave without running exit handlers or flushing stdio copied from the parent
+            _exit(0);
+        }
+    }
+    int failed = false;
+    for (shard = 0; shard < shardCount; shard++) {
+        int status;
+        if (waitpid(shards[shard], &status, 0) != shards[shard] || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("Scoring shard %d failed.\n", shard);
+            failed = true;
+        }
+    }
+    if (failed) {
+        exit(-1);
+    }
+    // merge: every shard wrote the scores of its own range of words
+    memcpy(store->scores, sharedScores, sizeof(int) * size);
+    munmap(sharedScores, scoresSize);
+    free(shards);
+}
+
+/*
+ * Same as scoreCompute(..), with the answers already packed.
+ * Param: (wordStoreStruct*) the store of the words to score, (const packedAnswersStruct*) the packed answers, (int)
+ * amount of words to have scores computed, from the first, (int) number of processes to split the words over, 1 to
+ * score them all in this one, (workerPoolStruct*) worker pool to score words in parallel, or NULL
+ */
+void scorePackedCompute(wordStoreStruct *store, const packedAnswersStruct *packedAnswers, int size, int shardCount,
+                        workerPoolStruct *pool) {
+    STATS_START(timer);
+    if (shardCount > 1 && size >= shardCount) {
+        scoreShardedCompute(store, packedAnswers, size, shardCount, pool);
+    }
+    else {
+        scoreJobStruct scoreJob;
+        scoreJob.guesses = store->packed;
+        scoreJob.scores = store->scores;
+        scoreJob.packedAnswers = packedAnswers;
+        workerPoolRun(pool, scoreComputeRange, &scoreJob, size, SCORE_CHUNK_SIZE);
+    }
+    STATS_COUNT(STATS_PAIRS, (long long)size * packedAnswers->count);
+    STATS_STOP(timer, STATS_SCORE);
+}
+
+/*
+ * Compute scores of however many words indicated by size, starting from the first word of the store. Scores are
+ * computed relative to the answer words the store starts with (with a specified amount of answers of consideration).
+ * Each word's score only depends on the answers, so with a worker pool the words are split over its threads, giving
+ * the same scores as computing them one by one.
+ * Param: (wordStoreStruct*) the store of the words to score, (int) amount of answer words of consideration, (int)
+ * amount of words to have scores computed, (int) number of processes to split the words over, 1 for this one only,
+ * (workerPoolStruct*) worker pool to score words in parallel, or NULL
+ */
+void scoreCompute(wordStoreStruct *store, int answersCounter, int size, int shardCount, workerPoolStruct *pool) {
+    // pack the answers once, then every guess is scored against all of them by the scoring kernel
+    packedAnswersStruct packedAnswers;
+    packStoredAnswers(&packedAnswers, store, answersCounter);
+    scorePackedCompute(store, &packedAnswers, size, shardCount, pool);
+    freePackedAnswers(&packedAnswers);
+}
+
+/*
+ * struct: reducedAnswersStruct
+ * Scratch space for secondScoreCompute(..), allocated once and reused for every word the answers are blanked out by.
+ * Blanking out letters makes many answers the same, so each different blanked answer is scored against only once,
+ * weighted by how many answers it stands for.
+ */
+typedef struct reducedAnswers reducedAnswersStruct;
+struct reducedAnswers{
+    unsigned long long *keys;     // Packed letters of each blanked answer, sorted to bring the same ones together
+    packedAnswersStruct packed;   // Each different blanked answer once, with its weight
+};
+
+void allocateReducedAnswers(reducedAnswersStruct *reducedAnswers, int answersCounter, int wordLength) {
+    reducedAnswers->keys = (unsigned long long *)malloc(sizeof(unsigned long long)
+                                                        * (answersCounter > 0 ? answersCounter : 1));
+    allocatePackedAnswers(&reducedAnswers->packed, answersCounter, wordLength, true);
+}
+
+void freeReducedAnswers(reducedAnswersStruct *reducedAnswers) {
+    free(reducedAnswers->keys);
+    freePackedAnswers(&reducedAnswers->packed);
+}
+
+int compareUnsignedLongLong(const void *a, const void *b) {
+    unsigned long long first = *(const unsigned long long *)a;
+    unsigned long long second = *(const unsigned long long *)b;
+    return (first > second) - (first < second);
+}
+
+/*
+ * In consideration of the second best words, the answer words are mutated: the letters are blanked out; thus, the
+ * function first blanks out a copy of each answerWord based on which word is meant to be used as a blanking out. The
+ * answers the store starts with are left as they are. Answers that end up the same are collapsed into one weighted
+ * answer, which gives the same total scores. Afterwards, utilize the score computing function to finish the rest.
+ * Param: (wordStoreStruct*) the store of the words to score, answer words first, (int) amount of answer words of
+ * consideration, (int) amount of words to have scores computed, (int) index in the store of the word based upon which
+ * to blank out all the answersWord from, (reducedAnswersStruct*) scratch space with room for all the answers, made for
+ * their length, (int) number of processes to split the words over, 1 for this one only, (workerPoolStruct*) worker
+ * pool to score words in parallel, or NULL
+ */
+void secondScoreCompute(wordStoreStruct *store, int answersCounter, int size, int wordToRemove,
+                        reducedAnswersStruct *reducedAnswers, int shardCount, workerPoolStruct *pool) {
+    STATS_START(timer);
+    int i = 0;
+    int wordLength = store->wordLength;
+    char blankedWord[ MAX_WORD_LENGTH + 1];
+    char cpyRemoveWord[ MAX_WORD_LENGTH + 1]; //score assigning function applies onto char array, which is forced as pass by reference (due to array construction), so require a copy to not completely mutate
+    blankedWord[wordLength] = '\0';
+    cpyRemoveWord[wordLength] = '\0';
+    for (; i < answersCounter; i ++) {
+        memcpy(blankedWord, storedWord(store, i), wordLength);
+        memcpy(cpyRemoveWord, storedWord(store, wordToRemove), wordLength);
+        // this function is less about assigning score, but more so to mutate the words (blanking letters)
+        scoreAssigning(blankedWord, cpyRemoveWord, wordLength);
+//        printf(" %d. %s\n", i, blankedWord); // debug: print all the words post-blanking
+        packedWordStruct packed;
+        packWord(blankedWord, &packed, ANSWER_BLANK_CODE, wordLength);
+        reducedAnswers->keys[i] = packedWordKey(&packed);
+    }
+    // the packed letters say exactly what a blanked answer is, so sorting them brings the same answers together
+    qsort(reducedAnswers->keys, answersCounter, sizeof(unsigned long long), compareUnsignedLongLong);
+    int uniqueCount = 0;
+    i = 0;
+    while (i < answersCounter) {
+        int sameCount = 1;
+        while (i + sameCount < answersCounter && reducedAnswers->keys[i + sameCount] == reducedAnswers->keys[i]) {
+            sameCount++;
+        }
+        unpackWordKey(reducedAnswers->keys[i], blankedWord, wordLength);
+        packedWordStruct packed;
+        packWord(blankedWord, &packed, ANSWER_BLANK_CODE, wordLength);
+        // weights have to stay below 2^15 for the SSE2 kernel, bigger groups take more than one entry
+        int weightLeft = sameCount;
+        while (weightLeft > 0) {
+            int weight = weightLeft < MAX_ANSWER_WEIGHT ? weightLeft : MAX_ANSWER_WEIGHT;
+            setPackedAnswer(&reducedAnswers->packed, uniqueCount++, &packed, (unsigned int)weight);
+            weightLeft -= weight;
+        }
+        i += sameCount;
+    }
+    finishPackedAnswers(&reducedAnswers->packed, uniqueCount);
+    STATS_STOP(timer, STATS_BLANK);
+    // compute the scores, assigning scores to each word in the word bank based on answersWords that are already blanked out at this point
+    scorePackedCompute(store, &reducedAnswers->packed, size, shardCount, pool);
+}
+
+/*
+ * Composite function to score all words of the store, answers and guesses, against the answer words: calculate the
+ * best first word to guess, assigning scores to each word and, if the full order is asked for, sort the word indexes
+ * based on score/alphabetically. The highest scored words can be picked out without sorting, see
+ * selectHighestScoredWords(..) and selectTopWords(..). The answer words stay at the start of the store, so there is
+ * no copy of them to keep for blanking out letters later.
+ * Param: (wordStoreStruct*) the store of all words, answer words first, (int) how many answerWords there are, (int)
+ * how many guessesWords there are, (int[]) room for the index of every word, filled in sorted order if fullOrder,
+ * (int) whether to sort all words, (int) number of processes to split scoring over, 1 for this one only,
+ * (workerPoolStruct*) worker pool to score words in parallel, or NULL
+ */
+void parseAndCompute(wordStoreStruct *store, int answersCounter, int guessesCounter, int order[], int fullOrder,
+                     int shardCount, workerPoolStruct *pool) {
+    scoreCompute(store, answersCounter, answersCounter + guessesCounter, shardCount, pool);
+    // Sort the words in descending order by score, and within score they should also be sorted into ascending order
+    // alphabetically. Only the indexes move, with the heap sort of sortStoredWords(..).
+    if (fullOrder) {
+        int i = 0;
+        for (; i < answersCounter + guessesCounter; i++) {
+            order[i] = i;
+        }
+        sortStoredWords(store, order, answersCounter + guessesCounter);
+    }
+}
+
+/*
+ * struct: secondWordsReportStruct
+ * The highest scored first words and, for each of them, the highest scored second words, as word indexes of the store.
+ * The second words of first word i are secondWords[secondStarts[i]] up to secondWords[secondStarts[i + 1]].
+ */
+typedef struct secondWordsReport secondWordsReportStruct;
+struct secondWordsReport{
+    int firstCount;      // Number of first words tied for the highest score
+    int *firstWords;     // Index of each first word
+    int *firstScores;    // Score of each first word against the full answer words
+    int *secondStarts;   // firstCount + 1 starts of the second words of each first word in secondWords
+    int *secondWords;    // Index of each second word
+    int *secondScores;   // Score of each second word against the answer words blanked out by its first word
+    int secondCount;     // Number of second words of all first words
+};
+
+/*
+ * Set up a report of first and second words with room for the given numbers of words. Must be freed with
+ * freeSecondWordsReport(..).
+ * Param: (secondWordsReportStruct*) the report, (int) number of first words, (int) number of second words
+ */
+void allocateSecondWordsReport(secondWordsReportStruct *report, int firstCount, int secondCount) {
+    report->firstCount = firstCount;
+    report->secondCount = secondCount;
+    report->firstWords = (int *)malloc(sizeof(int) * (firstCount + 1));
+    report->firstScores = (int *)malloc(sizeof(int) * (firstCount + 1));
+    report->secondStarts = (int *)malloc(sizeof(int) * (firstCount + 1));
+    report->secondWords = (int *)malloc(sizeof(int) * (secondCount + 1));
+    report->secondScores = (int *)malloc(sizeof(int) * (secondCount + 1));
+    report->secondStarts[0] = 0;
+}
+
+void freeSecondWordsReport(secondWordsReportStruct *report) {
+    free(report->firstWords);
+    free(report->firstScores);
+    free(report->secondStarts);
+    free(report->secondWords);
+    free(report->secondScores);
+}
+
+/*
+ * Process which word is the best second word post-first best word computation. Extract all the highest scored words,
+ * process second-best words in the same manner as the first-best word, but based on the answer words that had letters
+ * struck out from the highest scored words, instead of full answer words. The lists of highest scored words come from
+ * the scratch arena, so nothing is allocated per word; the results are kept in a report, see printSecondWords(..).
+ * Param: (wordStoreStruct*) the store of all words, which at this point has scores relative to full-letter answer
+ * words, (int) count of all answer words, (int) count of all guess words, (secondWordsReportStruct*) report to fill
+ * in, freed with freeSecondWordsReport(..), (int) number of processes to split scoring over, 1 for this one only,
+ * (workerPoolStruct*) worker pool to score words in parallel, or NULL
+ */
+void bestSecondWordsProcessing(wordStoreStruct *store, int answersCounter, int guessesCounter,
+                               secondWordsReportStruct *report, int shardCount, workerPoolStruct *pool) {
+    int wordLength = store->wordLength;
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    // first extract all the highest scored words, with their scores, since the scores of all words are going to be
+    // overwritten after the consideration with the first highest scoring word.
+    int highestScoredWordsTie = 0;
+    int *highestScoredWords = selectHighestScoredWords(store, answersCounter + guessesCounter, arena,
+                                                       &highestScoredWordsTie);
+    // second words are added as they are found, the room for them grows as needed
+    int secondCapacity = highestScoredWordsTie;
+    allocateSecondWordsReport(report, highestScoredWordsTie, secondCapacity);
+    report->secondCount = 0;
+    int i = 0;
+    for (; i < highestScoredWordsTie; i++) {
+        report->firstWords[i] = highestScoredWords[i];
+        report->firstScores[i] = store->scores[highestScoredWords[i]];
+    }
+    // room to blank out the answers in, reused for every highest scored word
+    reducedAnswersStruct reducedAnswers;
+    allocateReducedAnswers(&reducedAnswers, answersCounter, wordLength);
+    i = 0;
+
+    while (i < highestScoredWordsTie) {
+        /* Debug:
+        printf("answerWordsCopy after letters from %.*s removed:\n",
+               wordLength, storedWord(store, highestScoredWords[i]));
+         */
+        // compute score (second compute score) based on what word to blank out, then pick out the highest scored words
+        // with now new scores assigned relative to the answer words array, assumed to have letters struck out.
+        secondScoreCompute(store, answersCounter, answersCounter + guessesCounter, highestScoredWords[i],
+                           &reducedAnswers, shardCount, pool);
+        int j = 0;
+        /* Debug: Words and their scores relative to the answer words that were blanked out by the best first word
+        for (; j < answersCounter + guessesCounter; j++) {
+            printf("    %.*s %d\n", wordLength, storedWord(store, j), store->scores[j]);
+        }
+         */
+        size_t wordMark = arena->used;
+        int secondWordsTie = 0;
+        int *secondWords = selectHighestScoredWords(store, answersCounter + guessesCounter, arena, &secondWordsTie);
+        if (report->secondCount + secondWordsTie > secondCapacity) {
+            secondCapacity = (report->secondCount + secondWordsTie) * 2;
+            report->secondWords = (int *)realloc(report->secondWords, sizeof(int) * secondCapacity);
+            report->secondScores = (int *)realloc(report->secondScores, sizeof(int) * secondCapacity);
+            STATS_COUNT(STATS_ALLOCATIONS, 2);
+        }
+        for (j = 0; j < secondWordsTie; j++) {
+            report->secondWords[report->secondCount] = secondWords[j];
+            report->secondScores[report->secondCount] = store->scores[secondWords[j]];
+            report->secondCount++;
+        }
+        report->secondStarts[i + 1] = report->secondCount;
+        arenaRelease(arena, wordMark);
+        i++;
+    }
+    freeReducedAnswers(&reducedAnswers);
+    arenaRelease(arena, mark);
+}
+
+/*
+ * Print each first word of a report with its score, followed by a line of its second words and their scores.
+ * Param: (const wordStoreStruct*) the store the word indexes are for, (const secondWordsReportStruct*) the report
+ */
+void printSecondWords(const wordStoreStruct *store, const secondWordsReportStruct *report) {
+    int wordLength = store->wordLength;
+    int i = 0;
+    for (; i < report->firstCount; i++) {
+        printf("%.*s %d\n", wordLength, storedWord(store, report->firstWords[i]), report->firstScores[i]);
+        int j = report->secondStarts[i];
+        for (; j < report->secondStarts[i + 1]; j++) {
+            printf("   %.*s %d", wordLength, storedWord(store, report->secondWords[j]), report->secondScores[j]);
+        }
+        printf("\n");
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+// Ranking cache.  The scores of the first words and the second words of the best of them
+// only depend on the answer and guess words, so the best words report can keep them in a
+// ranking cache file and, as long as the words are the same, read them back instead of
+// scoring everything again.
+
+/*
+ * struct: rankingCacheHeaderStruct
+ * Start of a ranking cache file, followed by the answerCount + guessCount scores of the words and the same number of
+ * word indexes in compareStoredWords(..) order, then the firstWords, firstScores and secondStarts of a
+ * secondWordsReportStruct (firstCount, firstCount and firstCount + 1 ints) and its secondWords and secondScores
+ * (secondCount ints each).
+ */
+typedef struct rankingCacheHeader rankingCacheHeaderStruct;
+struct rankingCacheHeader{
+    char magic[ 8];                     // RANKING_CACHE_MAGIC
+    unsigned int version;               // RANKING_CACHE_VERSION
+    unsigned int scoringMode;           // RANKING_SCORING_MODE the scores were computed with
+    unsigned int wordLength;            // Length of the words
+    unsigned int answerCount;           // Number of answer words
+    unsigned int guessCount;            // Number of guess words
+    unsigned int firstCount;            // Number of first words of the report
+    unsigned int secondCount;           // Number of second words of the report
+    unsigned int reserved;              // Always 0
+    unsigned long long dictionaryHash;  // Hash of the words, answers first, see dictionaryHash(..)
+    unsigned long long contentHash;     // Hash of everything after the header, see rankingCacheContentHash(..)
+};
+
+/*
+ * Hash of the letters of a word store, the same as dictionaryHash(..) of the words it was made from.
+ * Param: (const wordStoreStruct*) the store
+ * Output: The hash
+ */
+unsigned long long wordStoreHash(const wordStoreStruct *store) {
+    return contentHash(store->letters, (size_t)store->count * store->wordLength, FNV_OFFSET_BASIS);
+}
+
+/*
+ * Hash of what a ranking cache keeps after its header, in the order it is kept.
+ * Param: (const int[]) score of every word, (const int[]) index of every word in sorted order, (int) number of words,
+ * (const secondWordsReportStruct*) the second words
+ * Output: The hash
+ */
+unsigned long long rankingCacheContentHash(const int scores[], const int order[], int wordCount,
+                                           const secondWordsReportStruct *report) {
+    int firstCount = report->firstCount;
+    int secondCount = report->secondCount;
+    unsigned long long hash = contentHash((const char *)scores, sizeof(int) * wordCount, FNV_OFFSET_BASIS);
+    hash = contentHash((const char *)order, sizeof(int) * wordCount, hash);
+    hash = contentHash((const char *)report->firstWords, sizeof(int) * firstCount, hash);
+    hash = contentHash((const char *)report->firstScores, sizeof(int) * firstCount, hash);
+    hash = contentHash((const char *)report->secondStarts, sizeof(int) * (firstCount + 1), hash);
+    hash = contentHash((const char *)report->secondWords, sizeof(int) * secondCount, hash);
+    return contentHash((const char *)report->secondScores, sizeof(int) * secondCount, hash);
+}
+
+/*
+ * Read the scores, order and second words of a ranking cache, if it is there and was made from the same words with
+ * the same scoring. The contents are checked against their hash, the order to hold every word once and every word
+ * index to be one of the store, so a damaged file is only a miss.
+ * Param: (char[]) ranking cache file name, (wordStoreStruct*) the store of all words, answer words first, whose scores
+ * are filled in, (int) how many answer words there are, (int[]) room for the index of every word, filled in sorted
+ * order, (secondWordsReportStruct*) report to fill in, only to be freed with freeSecondWordsReport(..) on a hit
+ * Output: true if everything came from the cache, false if the cache is missing, out of date or damaged
+ */
+int readRankingCache(char cacheFileName[], wordStoreStruct *store, int answersCounter, int order[],
+                     secondWordsReportStruct *report) {
+    STATS_START(timer);
+    FILE *cacheFilePtr = fopen(cacheFileName, "rb");
+    if (cacheFilePtr == NULL) {
+        STATS_STOP(timer, STATS_LOAD);
+        return false;
+    }
+    int wordCount = store->count;
+    rankingCacheHeaderStruct header;
+    struct stat fileStatus;
+    if (fread(&header, sizeof(header), 1, cacheFilePtr) != 1 || memcmp(header.magic, RANKING_CACHE_MAGIC, 8) != 0
+        || header.version != RANKING_CACHE_VERSION || header.scoringMode != RANKING_SCORING_MODE
+        || header.wordLength != (unsigned int)store->wordLength || header.answerCount != (unsigned int)answersCounter
+        || header.guessCount != (unsigned int)(wordCount - answersCounter)
+        || header.firstCount > (unsigned int)wordCount || header.dictionaryHash != wordStoreHash(store)
+        || fstat(fileno(cacheFilePtr), &fileStatus) != 0
+        || (size_t)fileStatus.st_size != sizeof(header) + sizeof(int) * (2 * (size_t)wordCount
+                                          + 3 * (size_t)header.firstCount + 1 + 2 * (size_t)header.secondCount)) {
+        fclose(cacheFilePtr);
+        STATS_STOP(timer, STATS_LOAD);
+        return false;
+    }
+    allocateSecondWordsReport(report, (int)header.firstCount, (int)header.secondCount);
+    int firstCount = report->firstCount;
+    int secondCount = report->secondCount;
+    int valid = fread(store->scores, sizeof(int), wordCount, cacheFilePtr) == (size_t)wordCount
+                && fread(order, sizeof(int), wordCount, cacheFilePtr) == (size_t)wordCount
+                && fread(report->firstWords, sizeof(int), firstCount, cacheFilePtr) == (size_t)firstCount
+                && fread(report->firstScores, sizeof(int), firstCount, cacheFilePtr) == (size_t)firstCount
+                && fread(report->secondStarts, sizeof(int), firstCount + 1, cacheFilePtr) == (size_t)firstCount + 1
+                && fread(report->secondWords, sizeof(int), secondCount, cacheFilePtr) == (size_t)secondCount
+                && fread(report->secondScores, sizeof(int), secondCount, cacheFilePtr) == (size_t)secondCount;
+    fclose(cacheFilePtr);
+    valid = valid && rankingCacheContentHash(store->scores, order, wordCount, report) == header.contentHash;
+    char *seen = (char *)calloc(wordCount, sizeof(char));  // Whether each word was found in the order yet
+    if (seen == NULL) {
+        valid = false;
+    }
+    int i = 0;
+    for (; valid && i < wordCount; i++) {
+        valid = order[i] >= 0 && order[i] < wordCount && !seen[order[i]];
+        if (valid) {
+            seen[order[i]] = true;
+        }
+    }
+    free(seen);
+    for (i = 0; valid && i < firstCount; i++) {
+        valid = report->firstWords[i] >= 0 && report->firstWords[i] < wordCount
+                && report->secondStarts[i] <= report->secondStarts[i + 1];
+    }
+    valid = valid && report->secondStarts[0] == 0 && report->secondStarts[firstCount] == secondCount;
+    for (i = 0; valid && i < secondCount; i++) {
+        valid = report->secondWords[i] >= 0 && report->secondWords[i] < wordCount;
+    }
+    if (!valid) {
+        freeSecondWordsReport(report);
+        STATS_STOP(timer, STATS_LOAD);
+        return false;
+    }
+    STATS_STOP(timer, STATS_LOAD);
+    return true;
+}
+
+/*
+ * Save the scores, order and second words of the best words report to a ranking cache. Failing to write the cache
+ * only costs the time it would have saved, so it is not an error.
+ * Param: (char[]) ranking cache file name, (const wordStoreStruct*) the store of all words, answer words first, (int)
+ * how many answer words there are, (const int[]) score of every word against the full answer words, (const int[])
+ * index of every word in sorted order, (const secondWordsReportStruct*) the second words
+ */
+void writeRankingCache(char cacheFileName[], const wordStoreStruct *store, int answersCounter, const int scores[],
+                       const int order[], const secondWordsReportStruct *report) {
+    FILE *cacheFilePtr = fopen(cacheFileName, "wb");
+    if (cacheFilePtr == NULL) {
+        fprintf(stderr, "Could not write ranking cache %s.\n", cacheFileName);
+        return;
+    }
+    int wordCount = store->count;
+    int firstCount = report->firstCount;
+    int secondCount = report->secondCount;
+    rankingCacheHeaderStruct header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RANKING_CACHE_MAGIC, 8);
+    header.version = RANKING_CACHE_VERSION;
+    header.scoringMode = RANKING_SCORING_MODE;
+    header.wordLength = store->wordLength;
+    header.answerCount = answersCounter;
+    header.guessCount = wordCount - answersCounter;
+    header.firstCount = firstCount;
+    header.secondCount = secondCount;
+    header.dictionaryHash = wordStoreHash(store);
+    header.contentHash = rankingCacheContentHash(scores, order, wordCount, report);
+    int written = fwrite(&header, sizeof(header), 1, cacheFilePtr) == 1
+                  && fwrite(scores, sizeof(int), wordCount, cacheFilePtr) == (size_t)wordCount
+                  && fwrite(order, sizeof(int), wordCount, cacheFilePtr) == (size_t)wordCount
+                  && fwrite(report->firstWords, sizeof(int), firstCount, cacheFilePtr) == (size_t)firstCount
+                  && fwrite(report->firstScores, sizeof(int), firstCount, cacheFilePtr) == (size_t)firstCount
+                  && fwrite(report->secondStarts, sizeof(int), firstCount + 1, cacheFilePtr) == (size_t)firstCount + 1
+                  && fwrite(report->secondWords, sizeof(int), secondCount, cacheFilePtr) == (size_t)secondCount
+                  && fwrite(report->secondScores, sizeof(int), secondCount, cacheFilePtr) == (size_t)secondCount;
+    if (fclose(cacheFilePtr) != 0 || !written) {
+        // a cache cut short would only be rejected on the next start, so do not leave it behind
+        remove(cacheFileName);
+        fprintf(stderr, "Could not write ranking cache %s.\n", cacheFileName);
+    }
+}
+
+// -----------------------------------------------------------------------------------------
+
+void runWorstCaseAnalysis(const feedbackMatrixStruct *matrix, const wordStoreStruct *store, const int openings[],
+                          int openingCount, workerPoolStruct *pool);
+
+/*
+ * Report the best first words and, for each of them, the best second words or the worst case, for a file of answer
+ * words and a file of the other words that can be guessed.
+ * Param: (char[]) answers file name, (char[]) guesses file name, (int) whether to use word caches, (int) number of top
+ * first words to list, (int) whether to list all words in order, (int) whether to analyze the worst case of the top
+ * first words (all words with fullRanking) instead of finding their second words, (char[]) opening word to analyze the
+ * worst case of instead, NULL for the top first words, (char[]) ranking cache file to read the report from and write
+ * it to, NULL to always score the words, (int) number of processes to split scoring over, 1 for this one only,
+ * (workerPoolStruct*) worker pool to score words, or NULL
+ */
+int main2(char answersFileName[], char guessesFileName[], int useWordCache, int topCount, int fullRanking,
+          int analyzeWorstCase, char openingWord[], char rankingCacheFileName[], int shardCount,
+          workerPoolStruct *pool) {
+    int answersCounter = 0;
+    int guessesCounter = 0;
+    // Construct a container for all words, both guesses and answers; the answers stay first in it, for later usage of
+    // blanking out letters of answers based on "best first words"
+    wordCountStruct *allWords;
+    // Read in the files, answers first and guesses after them, so the answers are the first answersCounter words
+    allWords = NULL;
+    int wordLength = 0;
+    readWordsFromFile(answersFileName, &allWords, &answersCounter, &wordLength, useWordCache);
+    int wordCount = answersCounter;
+    readWordsFromFile(guessesFileName, &allWords, &wordCount, &wordLength, useWordCache);
+    if (wordCount == 0) {
+        printf("There are no words to score. Exiting...\n");
+        exit(-1);
+    }
+    guessesCounter = wordCount - answersCounter;
+    // Scoring only needs the words in the word store, laid out for it
+    wordStoreStruct store;
+    initializeWordStore(&store, allWords, wordCount, wordLength);
+    int openingIndex = -1;
+    int i = 0;
+    for (; openingWord != NULL && i < wordCount; i++) {
+        if ((int)strlen(openingWord) == wordLength && memcmp(openingWord, storedWord(&store, i), wordLength) == 0) {
+            openingIndex = i;
+            break;
+        }
+    }
+    if (openingWord != NULL && openingIndex < 0) {
+        printf("%s is not one of the words. Exiting...\n", openingWord);
+        exit(-1);
+    }
+    // the worst case analysis plays games with the words in file order, otherwise only the store is needed
+    if (!analyzeWorstCase) {
+        free(allWords);
+        allWords = NULL;
+    }
+    int *order = (int *)malloc(sizeof(int) * wordCount);
+    secondWordsReportStruct report;
+    int cached = rankingCacheFileName != NULL
+                 && readRankingCache(rankingCacheFileName, &store, answersCounter, order, &report);
+    if (!cached) {
+        // Count answers and guesses words, assign scores,
+        // compute best first word(s) and put all words into sorted order, always when it goes in the ranking cache,
+        // which the worst case analysis does not write.
+        parseAndCompute(&store, answersCounter, guessesCounter, order,
+                        fullRanking || (rankingCacheFileName != NULL && !analyzeWorstCase), shardCount, pool);
+    }
+    printf("%s has %d words\n%s has %d words\n", answersFileName, answersCounter, guessesFileName, guessesCounter);
+    if (fullRanking) {
+        printf("\nAll words and scores:\n");
+        for (i = 0; i < answersCounter + guessesCounter; i++) {
+            printf("%.*s %d\n", wordLength, storedWord(&store, order[i]), store.scores[order[i]]);
+        }
+    }
+    else if (topCount > 0) {
+        int *topWords = (int *)malloc(sizeof(int) * topCount);
+        int selected = selectTopWords(&store, answersCounter + guessesCounter, topCount, topWords);
+        printf("\nTop %d first words and scores:\n", selected);
+        for (i = 0; i < selected; i++) {
+            printf("%.*s %d\n", wordLength, storedWord(&store, topWords[i]), store.scores[topWords[i]]);
+        }
+        free(topWords);
+    }
+    if (analyzeWorstCase) {
+        // the worst case takes the place of the second words, so a ranking cache is read but not written
+        if (cached) {
+            freeSecondWordsReport(&report);
+        }
+        int *openings = (int *)malloc(sizeof(int) * wordCount);
+        int openingCount = 0;
+        if (openingIndex >= 0) {
+            openings[openingCount++] = openingIndex;
+        }
+        else if (fullRanking) {
+            memcpy(openings, order, sizeof(int) * wordCount);
+            openingCount = wordCount;
+        }
+        else if (topCount > 0) {
+            openingCount = selectTopWords(&store, wordCount, topCount < wordCount ? topCount : wordCount, openings);
+        }
+        else {
+            scratchArenaStruct *arena = threadScratchArena();
+            size_t mark = arena->used;
+            int *highestScoredWords = selectHighestScoredWords(&store, wordCount, arena, &openingCount);
+            memcpy(openings, highestScoredWords, sizeof(int) * openingCount);
+            arenaRelease(arena, mark);
+        }
+        printf("\nWorst case of %s, guessing to leave the fewest answers:\n",
+               openingIndex >= 0 ? "the opening word" : "top first words");
+        feedbackMatrixStruct matrix;
+        buildFeedbackMatrix(&matrix, allWords, wordCount, answersCounter, wordLength, pool);
+        runWorstCaseAnalysis(&matrix, &store, openings, openingCount, pool);
+        freeFeedbackMatrix(&matrix);
+        free(openings);
+        free(allWords);
+        free(order);
+        freeWordStore(&store);
+        printf("Done\n");
+        return 0;
+    }
+    printf("\nWords and scores for top first words and second words:\n");
+    if (!cached) {
+        // the first word scores are overwritten by the second words, keep them for the ranking cache
+        int *firstScores = NULL;
+        if (rankingCacheFileName != NULL) {
+            firstScores = (int *)malloc(sizeof(int) * wordCount);
+            memcpy(firstScores, store.scores, sizeof(int) * wordCount);
+        }
+        // if option 2, re-process the scores of the words based on the best first words
+        bestSecondWordsProcessing(&store, answersCounter, guessesCounter, &report, shardCount, pool);
+        if (rankingCacheFileName != NULL) {
+            writeRankingCache(rankingCacheFileName, &store, answersCounter, firstScores, order, &report);
+        }
+        free(firstScores);
+    }
+    printSecondWords(&store, &report);
+    freeSecondWordsReport(&report);
+    free(order);
+    freeWordStore(&store);
+    printf("Done\n");
+    return 0;
+} // end main()
+
+//-----------------------------------------------------------------------------------------
+// Letter frequencies.  The letter heuristic gives a word 10 points for each of its letters
+// that is the most common letter of the live words, 9 for the second most common, down to
+// 6 for the fifth.  The live words are the candidates of a game, and the solver uses the
+// points (then how many candidates share each letter's position) to pick between guesses
+// that split the candidates equally well.  The counts behind it are kept in a table,
+// overall and per position, that is tallied once for all answer words and then updated as
+// candidates are eliminated, so a turn costs a step per eliminated candidate instead of a
+// pass over the candidates, and the points of a word are looked up letter by letter.
+
+/*
+ * struct: letterFrequencyStruct
+ * The counts are over the live words; a game starts from a copy of the solver's table of all answer words.
+ */
+typedef struct letterFrequency letterFrequencyStruct;
+struct letterFrequency{
+    int letterCounts[ 26];                       // Appearances of each letter, counting every copy
+    int positionCounts[ MAX_WORD_LENGTH][ 26];   // Live words with each letter at each position
+    int liveCount;                               // Number of live words
+    int wordLength;                              // Length of the words
+    int letterPoints[ 26];                       // Points of each letter, from the most common letters
+    int pointsOutdated;                          // Whether the counts changed since letterPoints was worked out
+};
+
+void initializeLetterCountStruct(letterCountStruct* allLetters) {
+    int i = 0;
+    for (; i <= 122 - 97; i++) {
+        allLetters->letter = i + 97;
+        allLetters->appearances = 0;
+        allLetters++;
+    }
+}
+
+/*
+ * Add a word to the counts, or take it out again with a change of -1.
+ */
+void letterFrequencyChange(letterFrequencyStruct *frequencies, const char word[], int change) {
+    int k = 0;
+    for (; k < frequencies->wordLength; k++) {
+        int letter = word[k] - 'a';
+        frequencies->letterCounts[letter] += change;
+        frequencies->positionCounts[k][letter] += change;
+    }
+    frequencies->liveCount += change;
+    frequencies->pointsOutdated = true;
+}
+
+/*
+ * Tally the letters of the live words, once.
+ * Param: (letterFrequencyStruct*) the table, (const wordCountStruct[]) all words in file order, (const int[]) file
+ * index of each live word, or NULL if they are the first liveCount words, (int) number of live words, (int) length of
+ * the words
+ */
+void initializeLetterFrequencies(letterFrequencyStruct *frequencies, const wordCountStruct allWords[],
+                                 const int liveWords[], int liveCount, int wordLength) {
+    memset(frequencies, 0, sizeof(letterFrequencyStruct));
+    frequencies->wordLength = wordLength;
+    int i = 0;
+    for (; i < liveCount; i++) {
+        letterFrequencyChange(frequencies, (allWords + (liveWords != NULL ? liveWords[i] : i))->word, 1);
+    }
+}
+
+/*
+ * Take an eliminated word out of the counts.
+ * Param: (letterFrequencyStruct*) the table, (const char[]) the word, which was live
+ */
+void letterFrequencyEliminate(letterFrequencyStruct *frequencies, const char word[]) {
+    letterFrequencyChange(frequencies, word, -1);
+}
+
+/*
+ * Rank the letters by their counts, most common first and ties in alphabetical order, and work out the points of each
+ * letter again if the counts changed. Ranking 26 letters costs the same however many words there are.
+ * Param: (letterFrequencyStruct*) the table, (letterCountStruct[]) 26 letters to fill in, ranked
+ */
+void rankLetters(letterFrequencyStruct *frequencies, letterCountStruct allLetters[]) {
+    initializeLetterCountStruct(allLetters);
+    int letter = 0;
+    for (; letter < 26; letter++) {
+        (allLetters + letter)->appearances = frequencies->letterCounts[letter];
+    }
+    qsort(allLetters, 26, sizeof(letterCountStruct), compareFunctionLetter);
+    if (frequencies->pointsOutdated) {
+        memset(frequencies->letterPoints, 0, sizeof(frequencies->letterPoints));
+        int k = 0;
+        for (; k < 5; k++) {
+            frequencies->letterPoints[(allLetters + k)->letter - 'a'] = 10 - k;
+        }
+        frequencies->pointsOutdated = false;
+    }
+}
+
+/*
+ * Letter heuristic points of a word, a lookup per letter. The points must be up to date, see rankLetters(..).
+ */
+int letterScoreOfWord(const letterFrequencyStruct *frequencies, const char word[]) {
+    int score = 0;
+    int k = 0;
+    for (; k < frequencies->wordLength; k++) {
+        score += frequencies->letterPoints[word[k] - 'a'];
+    }
+    return score;
+}
+
+/*
+ * Number of live words each letter of a word is in the same position in, added up: how many greens the word can
+ * expect to get, times the number of live words.
+ */
+int letterPositionScoreOfWord(const letterFrequencyStruct *frequencies, const char word[]) {
+    int score = 0;
+    int k = 0;
+    for (; k < frequencies->wordLength; k++) {
+        score += frequencies->positionCounts[k][word[k] - 'a'];
+    }
+    return score;
+}
+
+//-----------------------------------------------------------------------------------------
+// Candidate sets.  The answer words that could still be the secret word are kept as one bit
+// per answer word, so narrowing them down by feedback is an AND of 64 words at a time and
+// counting them is a popcount of each 64 bit block.
+
+/*
+ * struct: candidateSetStruct
+ * bits: bit i % 64 of block i / 64 is set if answer word i (by file index) is a candidate; bits past the last answer
+ * word are always 0
+ */
+typedef struct candidateSet candidateSetStruct;
+struct candidateSet{
+    unsigned long long *bits;  // One bit per answer word
+    int blockCount;            // Number of 64 bit blocks
+    int answerCount;           // Number of answer words
+};
+
+/*
+ * Set up a candidate set with every answer word in it. Must be freed with freeCandidateSet(..).
+ * Param: (candidateSetStruct*) the set, (int) number of answer words
+ */
+void initializeCandidateSet(candidateSetStruct *set, int answerCount) {
+    set->answerCount = answerCount;
+    set->blockCount = (answerCount + 63) / 64;
+    set->bits = (unsigned long long *)malloc(sizeof(unsigned long long) * (set->blockCount > 0 ? set->blockCount : 1));
+    STATS_COUNT(STATS_ALLOCATIONS, 1);
+    int block = 0;
+    for (; block < set->blockCount; block++) {
+        set->bits[block] = ~0ULL;
+    }
+    if (answerCount % 64 != 0) {
+        set->bits[set->blockCount - 1] = (1ULL << (answerCount % 64)) - 1;
+    }
+}
+
+void freeCandidateSet(candidateSetStruct *set) {
+    free(set->bits);
+}
+
+int candidateSetContains(const candidateSetStruct *set, int answerIndex) {
+    return (set->bits[answerIndex / 64] >> (answerIndex % 64)) & 1;
+}
+
+/*
+ * Number of answer words in a candidate set.
+ */
+int candidateSetCount(const candidateSetStruct *set) {
+    int count = 0;
+    int block = 0;
+    for (; block < set->blockCount; block++) {
+        count += __builtin_popcountll(set->bits[block]);
+    }
+    return count;
+}
+
+/*
+ * Keep only the candidates that are also in another set of answer words, 64 at a time.
+ * Param: (candidateSetStruct*) the set to narrow down, (const unsigned long long[]) blocks of the other set
+ */
+void candidateSetAnd(candidateSetStruct *set, const unsigned long long otherBits[]) {
+    int block = 0;
+    for (; block < set->blockCount; block++) {
+        set->bits[block] &= otherBits[block];
+    }
+}
+
+/*
+ * List the file indexes of the candidates, in increasing order.
+ * Param: (const candidateSetStruct*) the set, (int[]) array to fill in, with room for every candidate
+ * Output: Number of candidates
+ */
+int candidateSetIndexes(const candidateSetStruct *set, int indexes[]) {
+    int count = 0;
+    int block = 0;
+    for (; block < set->blockCount; block++) {
+        unsigned long long bits = set->bits[block];
+        while (bits != 0) {
+            indexes[count++] = block * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;   // clear the lowest set bit
+        }
+    }
+    return count;
+}
+
+/*
+ * struct: patternBitsetsStruct
+ * For one guess word, the set of answer words giving each feedback pattern, in candidate set blocks. Only the patterns
+ * some answer word gives have a set.
+ */
+typedef struct patternBitsets patternBitsetsStruct;
+struct patternBitsets{
+    int *setOfPattern;         // Which set in bits belongs to each pattern, -1 if no answer gives it
+    unsigned long long *bits;  // blockCount blocks for each pattern that has a set
+};
+
+/*
+ * Build the answer word sets of every feedback pattern of a guess word, from its row of the feedback matrix.
+ * Param: (const feedbackMatrixStruct*) feedback matrix, (int) file index of the guess word, (int) blocks per set
+ * Output: The sets, to be freed with freePatternBitsets(..)
+ */
+patternBitsetsStruct *buildPatternBitsets(const feedbackMatrixStruct *matrix, int guessIndex, int blockCount) {
+    patternBitsetsStruct *patternBitsets = (patternBitsetsStruct *)malloc(sizeof(patternBitsetsStruct));
+    const unsigned char *row = feedbackMatrixRow(matrix, guessIndex);
+    patternBitsets->setOfPattern = (int *)malloc(sizeof(int) * matrix->patternCount);
+    int pattern = 0;
+    for (; pattern < matrix->patternCount; pattern++) {
+        patternBitsets->setOfPattern[pattern] = -1;
+    }
+    int setCount = 0;
+    int i = 0;
+    for (; i < matrix->answerCount; i++) {
+        pattern = feedbackMatrixPattern(matrix, row, i);
+        if (patternBitsets->setOfPattern[pattern] < 0) {
+            patternBitsets->setOfPattern[pattern] = setCount++;
+        }
+    }
+    patternBitsets->bits = (unsigned long long *)calloc((size_t)setCount * blockCount, sizeof(unsigned long long));
+    for (i = 0; i < matrix->answerCount; i++) {
+        pattern = feedbackMatrixPattern(matrix, row, i);
+        unsigned long long *set = patternBitsets->bits + (size_t)patternBitsets->setOfPattern[pattern] * blockCount;
+        set[i / 64] |= 1ULL << (i % 64);
+    }
+    return patternBitsets;
+}
+
+void freePatternBitsets(patternBitsetsStruct *patternBitsets) {
+    if (patternBitsets != NULL) {
+        free(patternBitsets->setOfPattern);
+        free(patternBitsets->bits);
+        free(patternBitsets);
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+// Solver.  Each turn the solver guesses the word that tells the most about the secret word:
+// the one whose feedback patterns split the remaining candidates up the most evenly, which
+// is the entropy of the pattern distribution.  For n candidates split into buckets of c
+// words each, the entropy is  log2(n) - sum(c * log2(c)) / n,  so the best guess is the one
+// with the smallest sum(c * log2(c)).  That sum is added up in fixed point so guesses that
+// split the candidates the same way get exactly the same value.
+// Candidates are narrowed down by ANDing the candidate set with the answer words that give
+// the same feedback, from the pattern sets of the guess.  Building those sets costs a pass
+// over all answer words, so they are kept for guesses made while many candidates are left
+// (like the opening guess, made in every game); once few candidates are left it is cheaper
+// to check each of them in the feedback matrix.
+
+/*
+ * struct: wordleSolverStruct
+ * Everything the solver works out once for a dictionary and reuses for every game.
+ */
+typedef struct wordleSolver wordleSolverStruct;
+struct wordleSolver{
+    wordCountStruct *allWords;           // All words, in file order, the answer words first
+    int wordCount;                       // Number of words that can be guessed
+    int answerCount;                     // Number of answer words
+    const feedbackMatrixStruct *matrix;  // Feedback of every word against every answer word
+    workerPoolStruct *pool;              // Worker pool to work out the opening guess, or NULL
+    long long *bucketCost;               // c * log2(c) in fixed point, for c from 0 to answerCount
+    int openingGuess;                    // Best first guess, the same for every game; -1 until worked out
+    patternBitsetsStruct **patternBitsets; // Feedback pattern sets of each guess word, NULL if not kept
+    int patternBitsetsCount;             // Number of guess words with pattern sets kept
+    pthread_mutex_t lock;                // Guards the opening guess and the pattern sets, games may run in parallel
+    const struct decisionTree *tree;     // Decision tree of every game to play from, NULL to work the guesses out
+    letterFrequencyStruct answerFrequencies; // Letters of all answer words, with their points, copied by each game
+};
+
+/*
+ * Set up a solver for a dictionary. Must be freed with freeWordleSolver(..).
+ * Param: (wordleSolverStruct*) solver to set up, (wordCountStruct[]) all words in file order, (int) number of words,
+ * (const feedbackMatrixStruct*) feedback matrix of the words, (workerPoolStruct*) worker pool, or NULL
+ */
+void initializeWordleSolver(wordleSolverStruct *solver, wordCountStruct allWords[], int wordCount,
+                            const feedbackMatrixStruct *matrix, workerPoolStruct *pool) {
+    solver->allWords = allWords;
+    solver->wordCount = wordCount;
+    solver->answerCount = matrix->answerCount;
+    solver->matrix = matrix;
+    solver->pool = pool;
+    solver->openingGuess = -1;
+    solver->patternBitsets = (patternBitsetsStruct **)calloc(wordCount, sizeof(patternBitsetsStruct *));
+    solver->patternBitsetsCount = 0;
+    solver->tree = NULL;
+    pthread_mutex_init(&solver->lock, NULL);
+    solver->bucketCost = (long long *)malloc(sizeof(long long) * (solver->answerCount + 1));
+    int c = 0;
+    for (; c <= solver->answerCount; c++) {
+        solver->bucketCost[c] = c < 2 ? 0 : llround(c * log2((double)c) * ENTROPY_FIXED_POINT_SCALE);
+    }
+    // ranked once here, so the games copying the table never write to it
+    letterCountStruct allLetters[ 26];
+    initializeLetterFrequencies(&solver->answerFrequencies, allWords, NULL, solver->answerCount, matrix->wordLength);
+    rankLetters(&solver->answerFrequencies, allLetters);
+}
+
+void freeWordleSolver(wordleSolverStruct *solver) {
+    int g = 0;
+    for (; g < solver->wordCount; g++) {
+        freePatternBitsets(solver->patternBitsets[g]);
+    }
+    free(solver->patternBitsets);
+    free(solver->bucketCost);
+    pthread_mutex_destroy(&solver->lock);
+}
+
+/*
+ * struct: guessJobStruct
+ * Data shared by the worker pool threads while evaluating every guess against the remaining candidates.
+ */
+typedef struct guessJob guessJobStruct;
+struct guessJob{
+    const wordleSolverStruct *solver;  // The solver
+    const int *candidates;             // File index of each remaining candidate
+    int candidateCount;                // Number of remaining candidates
+    long long *splitCost;              // Output: sum(c * log2(c)) over the pattern buckets of each guess
+};
+
+/*
+ * Worker pool job: work out how well the guesses from begin to end - 1 split up the candidates of a guessJobStruct,
+ * reading patterns of a given size from the feedback matrix. Copied out for both sizes below.
+ */
+static inline __attribute__((always_inline)) void guessSplitCostRangeOfPatternBytes(void *context, int begin, int end,
+                                                                                    int patternBytes) {
+    guessJobStruct *guessJob = (guessJobStruct *)context;
+    const long long *bucketCost = guessJob->solver->bucketCost;
+    int bucketSize[ MAX_NUMBER_OF_PATTERNS];
+    memset(bucketSize, 0, sizeof(int) * guessJob->solver->matrix->patternCount);
+    int g = begin;
+    for (; g < end; g++) {
+        const unsigned char *row = feedbackMatrixRow(guessJob->solver->matrix, g);
+        const unsigned short *wideRow = (const unsigned short *)row;
+        long long cost = 0;
+        int i = 0;
+        // add up the cost of each bucket as it grows, so only the buckets that are used have to be cleared again
+        for (; i < guessJob->candidateCount; i++) {
+            int pattern = patternBytes == 1 ? row[guessJob->candidates[i]] : wideRow[guessJob->candidates[i]];
+            int size = ++bucketSize[pattern];
+            cost += bucketCost[size] - bucketCost[size - 1];
+        }
+        for (i = 0; i < guessJob->candidateCount; i++) {
+            int pattern = patternBytes == 1 ? row[guessJob->candidates[i]] : wideRow[guessJob->candidates[i]];
+            bucketSize[pattern] = 0;
+        }
+        guessJob->splitCost[g] = cost;
+    }
+}
+
+void guessSplitCostRange1(void *context, int begin, int end) {
+    guessSplitCostRangeOfPatternBytes(context, begin, end, 1);
+}
+
+void guessSplitCostRange2(void *context, int begin, int end) {
+    guessSplitCostRangeOfPatternBytes(context, begin, end, 2);
+}
+
+/*
+ * Pick the guess with the highest entropy over the remaining candidates, out of all the words. On a tie, a word that
+ * could still be the secret word is preferred, then the word with the most letter heuristic points, then the word
+ * whose letters are in the same position as in the most candidates, then the word first in alphabetical order.
+ * Param: (const wordleSolverStruct*) the solver, (const int[]) file index of each remaining candidate, (int) number of
+ * remaining candidates, (const candidateSetStruct*) the remaining candidates as a set, (letterFrequencyStruct*) letters
+ * of the remaining candidates, (workerPoolStruct*) worker pool to evaluate guesses on, or NULL
+ * Output: File index of the guess
+ */
+int bestEntropyGuess(const wordleSolverStruct *solver, const int candidates[], int candidateCount,
+                     const candidateSetStruct *candidateSet, letterFrequencyStruct *frequencies,
+                     workerPoolStruct *pool) {
+    STATS_START(timer);
+    guessJobStruct guessJob;
+    guessJob.solver = solver;
+    guessJob.candidates = candidates;
+    guessJob.candidateCount = candidateCount;
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    guessJob.splitCost = (long long *)arenaAllocate(arena, sizeof(long long) * solver->wordCount);
+    workerPoolRun(pool, solver->matrix->patternBytes == 1 ? guessSplitCostRange1 : guessSplitCostRange2, &guessJob,
+                  solver->wordCount, SCORE_CHUNK_SIZE);
+
+    letterCountStruct allLetters[ 26];
+    rankLetters(frequencies, allLetters);
+    int bestGuess = 0;
+    int g = 1;
+    for (; g < solver->wordCount; g++) {
+        long long cost = guessJob.splitCost[g];
+        long long bestCost = guessJob.splitCost[bestGuess];
+        if (cost != bestCost) {
+            if (cost < bestCost) {
+                bestGuess = g;
+            }
+            continue;
+        }
+        int gIsCandidate = g < solver->answerCount && candidateSetContains(candidateSet, g);
+        int bestIsCandidate = bestGuess < solver->answerCount && candidateSetContains(candidateSet, bestGuess);
+        if (gIsCandidate != bestIsCandidate) {
+            if (gIsCandidate) {
+                bestGuess = g;
+            }
+            continue;
+        }
+        const char *word = (solver->allWords + g)->word;
+        const char *bestWord = (solver->allWords + bestGuess)->word;
+        int points = letterScoreOfWord(frequencies, word);
+        int bestPoints = letterScoreOfWord(frequencies, bestWord);
+        if (points == bestPoints) {
+            points = letterPositionScoreOfWord(frequencies, word);
+            bestPoints = letterPositionScoreOfWord(frequencies, bestWord);
+        }
+        if (points > bestPoints || (points == bestPoints && strcmp(word, bestWord) < 0)) {
+            bestGuess = g;
+        }
+    }
+    arenaRelease(arena, mark);
+    STATS_COUNT(STATS_PAIRS, (long long)solver->wordCount * candidateCount);
+    STATS_COUNT(STATS_GUESSES, 1);
+    STATS_STOP(timer, STATS_GUESS);
+    return bestGuess;
+}
+
+/*
+ * Best first guess of the dictionary, worked out the first time it is asked for.
+ * Param: (wordleSolverStruct*) the solver
+ * Output: File index of the guess
+ */
+int solverOpeningGuess(wordleSolverStruct *solver) {
+    pthread_mutex_lock(&solver->lock);
+    if (solver->openingGuess < 0) {
+        candidateSetStruct candidateSet;
+        initializeCandidateSet(&candidateSet, solver->answerCount);
+        scratchArenaStruct *arena = threadScratchArena();
+        size_t mark = arena->used;
+        int *candidates = (int *)arenaAllocate(arena, sizeof(int) * solver->answerCount);
+        int candidateCount = candidateSetIndexes(&candidateSet, candidates);
+        letterFrequencyStruct frequencies = solver->answerFrequencies;
+        solver->openingGuess = bestEntropyGuess(solver, candidates, candidateCount, &candidateSet, &frequencies,
+                                                solver->pool);
+        arenaRelease(arena, mark);
+        freeCandidateSet(&candidateSet);
+    }
+    pthread_mutex_unlock(&solver->lock);
+    return solver->openingGuess;
+}
+
+/*
+ * Narrow the candidates down to the answer words that give the same feedback for a guess as the secret word did, and
+ * take each candidate that is eliminated out of the letter counts.
+ * Param: (wordleSolverStruct*) the solver, (candidateSetStruct*) the candidates, (letterFrequencyStruct*) letters of
+ * the candidates, (int) number of candidates, (int) file index of the guess, (int) feedback pattern the guess got
+ */
+void solverApplyFeedback(wordleSolverStruct *solver, candidateSetStruct *candidateSet,
+                         letterFrequencyStruct *frequencies, int candidateCount, int guessIndex, int pattern) {
+    pthread_mutex_lock(&solver->lock);
+    patternBitsetsStruct *patternBitsets = solver->patternBitsets[guessIndex];
+    // an AND costs one step per block, checking the candidates one step per candidate
+    if (patternBitsets == NULL && candidateCount > candidateSet->blockCount
+        && solver->patternBitsetsCount < PATTERN_BITSETS_LIMIT) {
+        patternBitsets = buildPatternBitsets(solver->matrix, guessIndex, candidateSet->blockCount);
+        solver->patternBitsets[guessIndex] = patternBitsets;
+        solver->patternBitsetsCount++;
+    }
+    pthread_mutex_unlock(&solver->lock);
+
+    int block = 0;
+    if (patternBitsets != NULL) {
+        int set = patternBitsets->setOfPattern[pattern];
+        // no answer word gives the feedback if there is no set for it
+        const unsigned long long *kept = set < 0 ? NULL : patternBitsets->bits + (size_t)set * candidateSet->blockCount;
+        for (; block < candidateSet->blockCount; block++) {
+            unsigned long long eliminated = candidateSet->bits[block] & (kept != NULL ? ~kept[block] : ~0ULL);
+            while (eliminated != 0) {
+                letterFrequencyEliminate(frequencies, (solver->allWords + block * 64 + __builtin_ctzll(eliminated))->word);
+                eliminated &= eliminated - 1;
+            }
+        }
+        if (kept == NULL) {
+            memset(candidateSet->bits, 0, sizeof(unsigned long long) * candidateSet->blockCount);
+        }
+        else {
+            candidateSetAnd(candidateSet, kept);
+        }
+        return;
+    }
+    const unsigned char *row = feedbackMatrixRow(solver->matrix, guessIndex);
+    for (; block < candidateSet->blockCount; block++) {
+        unsigned long long bits = candidateSet->bits[block];
+        while (bits != 0) {
+            int bit = __builtin_ctzll(bits);
+            if (feedbackMatrixPattern(solver->matrix, row, block * 64 + bit) != pattern) {
+                candidateSet->bits[block] &= ~(1ULL << bit);
+                letterFrequencyEliminate(frequencies, (solver->allWords + block * 64 + bit)->word);
+            }
+            bits &= bits - 1;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+// Decision tree.  The solver's guesses only depend on the feedback so far, so for a fixed
+// dictionary every game it can play is a path in one tree: the opening guess at the root
+// and, below each guess, a child for every feedback pattern some candidate gives.  The tree
+// is built once and written to a tree file: a decisionTreeHeaderStruct followed by the
+// nodes, root first, then the pattern bits of each node.  The children of a node are stored
+// next to each other in pattern order, so the child of a pattern is found by counting the
+// patterns below it in the node's pattern bits.  A tree file is memory-mapped and used as
+// it is.
+
+/*
+ * struct: decisionTreeNodeStruct
+ * One guess of the tree, as stored in a tree file.
+ */
+typedef struct decisionTreeNode decisionTreeNodeStruct;
+struct decisionTreeNode{
+    int guess;       // File index of the guess word
+    int firstChild;  // Node index of the child of the lowest pattern with one
+};
+
+/*
+ * struct: decisionTreeHeaderStruct
+ * Start of a tree file, followed by nodeCount decisionTreeNodeStruct, then patternWords unsigned long long of pattern
+ * bits for each node: bit p set if feedback pattern p has a child, never set for the all green pattern.
+ */
+typedef struct decisionTreeHeader decisionTreeHeaderStruct;
+struct decisionTreeHeader{
+    char magic[ 8];                     // DECISION_TREE_MAGIC
+    unsigned int version;               // DECISION_TREE_VERSION
+    unsigned int wordCount;             // Number of words of the dictionary
+    unsigned int answerCount;           // Number of answer words of the dictionary
+    unsigned int nodeCount;             // Number of nodes
+    unsigned int wordLength;            // Length of the words
+    unsigned int patternWords;          // 64 bit words of pattern bits per node
+    unsigned long long dictionaryHash;  // Hash of the words, see dictionaryHash(..)
+};
+
+/*
+ * struct: decisionTreeStruct
+ * A tree, either being built in memory or mapped from a tree file.
+ */
+typedef struct decisionTree decisionTreeStruct;
+struct decisionTree{
+    decisionTreeNodeStruct *nodes;  // The nodes, nodes[0] is the root
+    unsigned long long *patternBits; // patternWords words of pattern bits for each node
+    int patternWords;               // 64 bit words of pattern bits per node, enough for every pattern
+    int nodeCount;                  // Number of nodes
+    int capacity;                   // Nodes allocated while building, 0 when mapped
+    void *mapping;                  // Start of the mapped tree file, NULL while building
+    size_t mappingSize;             // Size of the mapped tree file
+};
+
+/*
+ * Hash of the words of a dictionary in file order, so a tree file is only used with the dictionary it was built for.
+ * Param: (const wordCountStruct*) all words, (int) how many, (int) length of the words
+ * Output: The hash
+ */
+unsigned long long dictionaryHash(const wordCountStruct *allWords, int wordCount, int wordLength) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    int i = 0;
+    for (; i < wordCount; i++) {
+        hash = contentHash((allWords + i)->word, wordLength, hash);
+    }
+    return hash;
+}
+
+/*
+ * Child of a node for a feedback pattern.
+ * Param: (const decisionTreeStruct*) the tree, (const decisionTreeNodeStruct*) the node, (int) feedback pattern
+ * Output: The child, or NULL if no answer word gives that feedback
+ */
+const decisionTreeNodeStruct *decisionTreeChild(const decisionTreeStruct *tree, const decisionTreeNodeStruct *node,
+                                                int pattern) {
+    const unsigned long long *patternBits = tree->patternBits + (size_t)(node - tree->nodes) * tree->patternWords;
+    int word = pattern / 64;
+    unsigned long long bit = 1ULL << (pattern % 64);
+    if ((patternBits[word] & bit) == 0) {
+        return NULL;
+    }
+    int rank = __builtin_popcountll(patternBits[word] & (bit - 1));
+    int w = 0;
+    for (; w < word; w++) {
+        rank += __builtin_popcountll(patternBits[w]);
+    }
+    return tree->nodes + node->firstChild + rank;
+}
+
+/*
+ * Work out the guess of a node, then add its children and work out theirs, depth first.
+ * Param: (wordleSolverStruct*) the solver, (decisionTreeStruct*) tree being built, (int) index of the node, already
+ * added, (const int[]) file index of each candidate left at the node, (int) number of candidates, (int) whether the
+ * node is the root
+ */
+void buildDecisionTreeNode(wordleSolverStruct *solver, decisionTreeStruct *tree, int nodeIndex,
+                           const int candidates[], int candidateCount, int isRoot) {
+    const feedbackMatrixStruct *matrix = solver->matrix;
+    int guess;
+    if (isRoot) {
+        guess = solverOpeningGuess(solver);
+    }
+    else if (candidateCount == 1) {
+        // every guess splits a single candidate the same way, and the candidate itself wins the tie
+        guess = candidates[0];
+    }
+    else {
+        candidateSetStruct candidateSet;
+        initializeCandidateSet(&candidateSet, solver->answerCount);
+        memset(candidateSet.bits, 0, sizeof(unsigned long long) * candidateSet.blockCount);
+        int i = 0;
+        for (; i < candidateCount; i++) {
+            candidateSet.bits[candidates[i] / 64] |= 1ULL << (candidates[i] % 64);
+        }
+        // the same letter counts a game has with these candidates left
+        letterFrequencyStruct frequencies;
+        initializeLetterFrequencies(&frequencies, solver->allWords, candidates, candidateCount, matrix->wordLength);
+        guess = bestEntropyGuess(solver, candidates, candidateCount, &candidateSet, &frequencies, solver->pool);
+        freeCandidateSet(&candidateSet);
+    }
+
+    // sort the candidates by the feedback the guess gets from them
+    const unsigned char *row = feedbackMatrixRow(matrix, guess);
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    int *bucketStart = (int *)arenaAllocate(arena, sizeof(int) * (2 * matrix->patternCount + 1));
+    memset(bucketStart, 0, sizeof(int) * (matrix->patternCount + 1));
+    int *bucketEnd = bucketStart + matrix->patternCount + 1;
+    int i = 0;
+    for (; i < candidateCount; i++) {
+        bucketStart[feedbackMatrixPattern(matrix, row, candidates[i]) + 1]++;
+    }
+    int pattern = 0;
+    for (; pattern < matrix->patternCount; pattern++) {
+        bucketStart[pattern + 1] += bucketStart[pattern];
+    }
+    int *sorted = (int *)arenaAllocate(arena, sizeof(int) * (candidateCount + 1));
+    memcpy(bucketEnd, bucketStart, sizeof(int) * matrix->patternCount);
+    for (i = 0; i < candidateCount; i++) {
+        sorted[bucketEnd[feedbackMatrixPattern(matrix, row, candidates[i])]++] = candidates[i];
+    }
+
+    int firstChild = tree->nodeCount;
+    int childCount = 0;
+    for (pattern = 0; pattern < matrix->patternCount; pattern++) {
+        childCount += pattern != matrix->allGreenPattern && bucketEnd[pattern] > bucketStart[pattern];
+    }
+    if (tree->nodeCount + childCount > tree->capacity) {
+        while (tree->nodeCount + childCount > tree->capacity) {
+            tree->capacity *= 2;
+        }
+        tree->nodes = (decisionTreeNodeStruct *)realloc(tree->nodes, sizeof(decisionTreeNodeStruct) * tree->capacity);
+        tree->patternBits = (unsigned long long *)realloc(tree->patternBits,
+                                                          sizeof(unsigned long long) * tree->capacity * tree->patternWords);
+        if (tree->nodes == NULL || tree->patternBits == NULL) {
+            printf("Not enough memory for the decision tree. Exiting...\n");
+            exit(-1);
+        }
+    }
+    tree->nodeCount += childCount;
+    (tree->nodes + nodeIndex)->guess = guess;
+    (tree->nodes + nodeIndex)->firstChild = firstChild;
+    unsigned long long *patternBits = tree->patternBits + (size_t)nodeIndex * tree->patternWords;
+    memset(patternBits, 0, sizeof(unsigned long long) * tree->patternWords);
+    for (pattern = 0; pattern < matrix->patternCount; pattern++) {
+        if (pattern != matrix->allGreenPattern && bucketEnd[pattern] > bucketStart[pattern]) {
+            patternBits[pattern / 64] |= 1ULL << (pattern % 64);
+        }
+    }
+
+    int child = firstChild;
+    for (pattern = 0; pattern < matrix->patternCount; pattern++) {
+        if (pattern != matrix->allGreenPattern && bucketEnd[pattern] > bucketStart[pattern]) {
+            buildDecisionTreeNode(solver, tree, child++, sorted + bucketStart[pattern],
+                                  bucketEnd[pattern] - bucketStart[pattern], false);
+        }
+    }
+    arenaRelease(arena, mark);
+}
+
+/*
+ * Build the tree of every game the solver can play with a dictionary. Must be freed with freeDecisionTree(..).
+ * Param: (decisionTreeStruct*) tree to build, (wordleSolverStruct*) the solver
+ */
+void buildDecisionTree(decisionTreeStruct *tree, wordleSolverStruct *solver) {
+    tree->capacity = 1024;
+    tree->patternWords = (solver->matrix->patternCount + 63) / 64;
+    tree->nodes = (decisionTreeNodeStruct *)malloc(sizeof(decisionTreeNodeStruct) * tree->capacity);
+    tree->patternBits = (unsigned long long *)malloc(sizeof(unsigned long long) * tree->capacity * tree->patternWords);
+    tree->nodeCount = 1;
+    tree->mapping = NULL;
+    tree->mappingSize = 0;
+    int *candidates = (int *)malloc(sizeof(int) * (solver->answerCount + 1));
+    int i = 0;
+    for (; i < solver->answerCount; i++) {
+        candidates[i] = i;
+    }
+    STATS_START(timer);
+    buildDecisionTreeNode(solver, tree, 0, candidates, solver->answerCount, true);
+    STATS_STOP(timer, STATS_TREE);
+    free(candidates);
+}
+
+/*
+ * Save a tree to a tree file.
+ * Param: (const decisionTreeStruct*) the tree, (const wordleSolverStruct*) the solver it was built with, (char[]) tree
+ * file name
+ */
+void writeDecisionTree(const decisionTreeStruct *tree, const wordleSolverStruct *solver, char treeFileName[]) {
+    FILE *treeFilePtr = fopen(treeFileName, "wb");
+    if (treeFilePtr == NULL) {
+        printf("Could not write tree file %s. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+    decisionTreeHeaderStruct header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DECISION_TREE_MAGIC, 8);
+    header.version = DECISION_TREE_VERSION;
+    header.wordCount = solver->wordCount;
+    header.answerCount = solver->answerCount;
+    header.nodeCount = tree->nodeCount;
+    header.wordLength = solver->matrix->wordLength;
+    header.patternWords = tree->patternWords;
+    header.dictionaryHash = dictionaryHash(solver->allWords, solver->wordCount, solver->matrix->wordLength);
+    size_t patternBitsCount = (size_t)tree->nodeCount * tree->patternWords;
+    if (fwrite(&header, sizeof(header), 1, treeFilePtr) != 1
+        || fwrite(tree->nodes, sizeof(decisionTreeNodeStruct), tree->nodeCount, treeFilePtr) != (size_t)tree->nodeCount
+        || fwrite(tree->patternBits, sizeof(unsigned long long), patternBitsCount, treeFilePtr) != patternBitsCount
+        || fclose(treeFilePtr) != 0) {
+        printf("Could not write tree file %s. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+}
+
+/*
+ * Map a tree file for the solver to play from. The nodes are used in place; they are only checked to point inside
+ * the file, so a damaged file cannot make a game read past it.
+ * Param: (decisionTreeStruct*) tree to map, (const wordleSolverStruct*) the solver, (char[]) tree file name
+ */
+void loadDecisionTree(decisionTreeStruct *tree, const wordleSolverStruct *solver, char treeFileName[]) {
+    int fileDescriptor = open(treeFileName, O_RDONLY);
+    struct stat fileStatus;
+    if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStatus) != 0) {
+        fprintf(stderr, "Could not open tree file %s. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+    size_t size = (size_t)fileStatus.st_size;
+    if (size < sizeof(decisionTreeHeaderStruct)) {
+        fprintf(stderr, "%s is not a tree file. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Could not map tree file %s. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+    const decisionTreeHeaderStruct *header = (const decisionTreeHeaderStruct *)mapping;
+    if (memcmp(header->magic, DECISION_TREE_MAGIC, 8) != 0 || header->version != DECISION_TREE_VERSION
+        || header->nodeCount == 0 || header->patternWords == 0
+        || size != sizeof(decisionTreeHeaderStruct) + (sizeof(decisionTreeNodeStruct)
+                    + sizeof(unsigned long long) * (size_t)header->patternWords) * header->nodeCount) {
+        fprintf(stderr, "%s is not a tree file. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+    if (header->wordCount != (unsigned int)solver->wordCount || header->answerCount != (unsigned int)solver->answerCount
+        || header->wordLength != (unsigned int)solver->matrix->wordLength
+        || header->patternWords != (unsigned int)(solver->matrix->patternCount + 63) / 64
+        || header->dictionaryHash != dictionaryHash(solver->allWords, solver->wordCount, solver->matrix->wordLength)) {
+        fprintf(stderr, "Tree file %s was built for different words. Exiting...\n", treeFileName);
+        exit(-1);
+    }
+    tree->nodes = (decisionTreeNodeStruct *)((char *)mapping + sizeof(decisionTreeHeaderStruct));
+    tree->nodeCount = (int)header->nodeCount;
+    tree->patternWords = (int)header->patternWords;
+    tree->patternBits = (unsigned long long *)(tree->nodes + tree->nodeCount);
+    tree->capacity = 0;
+    tree->mapping = mapping;
+    tree->mappingSize = size;
+    int i = 0;
+    for (; i < tree->nodeCount; i++) {
+        const decisionTreeNodeStruct *node = tree->nodes + i;
+        int childCount = 0;
+        int w = 0;
+        for (; w < tree->patternWords; w++) {
+            childCount += __builtin_popcountll(tree->patternBits[(size_t)i * tree->patternWords + w]);
+        }
+        if (node->guess < 0 || node->guess >= solver->wordCount
+            || (childCount > 0 && (node->firstChild <= i || node->firstChild > tree->nodeCount - childCount))) {
+            fprintf(stderr, "Tree file %s is damaged. Exiting...\n", treeFileName);
+            exit(-1);
+        }
+    }
+}
+
+void freeDecisionTree(decisionTreeStruct *tree) {
+    if (tree->mapping != NULL) {
+        munmap(tree->mapping, tree->mappingSize);
+    }
+    else {
+        free(tree->nodes);
+        free(tree->patternBits);
+    }
+}
+
+/*
+ * Print one guess the way the game shows it: the guess number and the guess word with green letters in uppercase,
+ * then a line with a '*' under every yellow letter.
+ * Param: (int) guess number, (char[]) guess word, (int) feedback pattern of the guess against the secret word
+ */
+void displayGuess(int guessNumber, char guessWord[], int pattern) {
+    int wordLength = (int)strlen(guessWord);
+    printf("%5d. ", guessNumber);
+    int k = 0;
+    for (; k < wordLength; k++) {
+        if (patternLetterState(pattern, k) == PATTERN_GREEN) {
+            printf("%c ", toupper(guessWord[k]));
+        }
+        else {
+            printf("%c ", guessWord[k]);
+        }
+    }
+    printf("\n       ");
+    for (k = 0; k < wordLength; k++) {
+        if (patternLetterState(pattern, k) == PATTERN_YELLOW) {
+            printf("* ");
+        }
+        else {
+            printf("  ");
+        }
+    }
+    printf("\n");
+}
+
+// -----------------------------------------------------------------------------------------
+// Find a secret word, returning how many guesses it took, or 0 if the secret word is not
+// one of the answer words
+int findSecretWord(
+        wordCountStruct allWords[],    // Array of all the words
+        char secretWord[],              // The word to be guessed
+        wordleSolverStruct *solver,     // Tables of the dictionary, shared by all games
+        workerPoolStruct *pool,         // Worker pool to evaluate guesses on, or NULL
+        int showGuesses)                // Whether to print the guesses
+{
+    char computerGuess[ MAX_WORD_LENGTH + 1];  // Allocate space for the computer guess
+    int wordLength = solver->matrix->wordLength;
+    int allGreenPattern = solver->matrix->allGreenPattern;
+
+    if( showGuesses) {
+        printf("Trying to find secret word: \n");
+        // Display secret word with a space between letters, to match the guess words below.
+        printf("       ");
+        for( int i=0; i<wordLength && secretWord[ i] != '\0'; i++) {
+            printf("%c ", secretWord[ i]);
+        }
+        printf("\n");
+        printf("\n");
+    }
+    // Feedback is only worked out for words of the dictionary's length
+    if( (int) strlen( secretWord) != wordLength) {
+        if( showGuesses) {
+            printf("The secret word is not a %d letter word.\n", wordLength);
+        }
+        return 0;
+    }
+
+    // With a decision tree the guesses are looked up in it, one node per guess. Otherwise every answer word starts
+    // out as a candidate for the secret word.
+    STATS_START( timer);
+    int useTree = solver->tree != NULL;
+    const decisionTreeNodeStruct *node = useTree ? solver->tree->nodes : NULL;
+    candidateSetStruct candidateSet;
+    letterFrequencyStruct frequencies;  // Letters of the candidates, kept up to date as they are eliminated
+    int *candidates = NULL;
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    if( !useTree) {
+        initializeCandidateSet( &candidateSet, solver->answerCount);
+        frequencies = solver->answerFrequencies;
+        candidates = (int *) arenaAllocate( arena, sizeof( int) * solver->answerCount);
+    }
+    // Loop until the word is found
+    int guessNumber = 1;
+    int pattern = 0;
+    while( pattern != allGreenPattern) {
+        int candidateCount = useTree ? 0 : candidateSetCount( &candidateSet);
+        if( useTree ? node == NULL : candidateCount == 0) {
+            if( showGuesses) {
+                printf("No words left that match the feedback, the secret word is not in the dictionary.\n");
+            }
+            break;
+        }
+        // Guess the word that tells the most about the secret word. The first guess is always the same, so work it out once.
+        int guessIndex;
+        if( useTree) {
+            guessIndex = node->guess;
+        }
+        else if( guessNumber == 1) {
+            guessIndex = solverOpeningGuess( solver);
+        }
+        else {
+            candidateSetIndexes( &candidateSet, candidates);
+            guessIndex = bestEntropyGuess( solver, candidates, candidateCount, &candidateSet, &frequencies, pool);
+        }
+        strcpy( computerGuess, allWords[ guessIndex].word);
+
+        // Feedback on the guess, then keep only the candidates that would have given the same feedback
+        pattern = feedbackPattern( secretWord, computerGuess, wordLength);
+        if( showGuesses) {
+            displayGuess( guessNumber, computerGuess, pattern);
+        }
+        if( useTree) {
+            // The tree has a child for every other feedback an answer word gives
+            if( pattern != allGreenPattern) {
+                node = decisionTreeChild( solver->tree, node, pattern);
+            }
+        }
+        else {
+            solverApplyFeedback( solver, &candidateSet, &frequencies, candidateCount, guessIndex, pattern);
+        }
+
+        // Update guess number
+        guessNumber++;
+    } //end while( pattern...)
+    if( !useTree) {
+        arenaRelease( arena, mark);
+        freeCandidateSet( &candidateSet);
+    }
+    STATS_STOP( timer, STATS_GAME);
+    if( pattern != allGreenPattern) {
+        return 0;
+    }
+    if( showGuesses) {
+        printf("Got it!\n");
+    }
+    return guessNumber - 1;
+} //end findSecretWord
+
+
+// -----------------------------------------------------------------------------------------
+// Batch benchmark.  Plays a game against every answer word (or a random sample of them)
+// without printing the guesses, then reports how many guesses the games took and how long
+// they took.  With more than one thread the games themselves are spread over the worker
+// pool, each game evaluating its guesses on its own thread.
+
+/*
+ * Seconds on a monotonic clock, for timing.
+ */
+double monotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/*
+ * struct: batchJobStruct
+ * Data shared by the worker pool threads while playing the games of a batch.
+ */
+typedef struct batchJob batchJobStruct;
+struct batchJob{
+    wordleSolverStruct *solver;   // The solver, shared by the games
+    const int *secretWords;       // File index of the secret word of each game
+    int *guessCounts;             // Output: guesses each game took, 0 if it failed
+    double *gameSeconds;          // Output: how long each game took
+    workerPoolStruct *gamePool;   // Worker pool each game evaluates guesses on, NULL when games run in parallel
+};
+
+/*
+ * Worker pool job: play the games from begin to end - 1 of a batchJobStruct.
+ */
+void playBatchGames(void *context, int begin, int end) {
+    batchJobStruct *batchJob = (batchJobStruct *)context;
+    wordleSolverStruct *solver = batchJob->solver;
+    int game = begin;
+    for (; game < end; game++) {
+        double startTime = monotonicSeconds();
+        batchJob->guessCounts[game] = findSecretWord(solver->allWords,
+                                                     (solver->allWords + batchJob->secretWords[game])->word,
+                                                     solver, batchJob->gamePool, false);
+        batchJob->gameSeconds[game] = monotonicSeconds() - startTime;
+    }
+}
+
+int compareDoubles(const void *a, const void *b) {
+    double first = *(const double *)a;
+    double second = *(const double *)b;
+    return (first > second) - (first < second);
+}
+
+/*
+ * Value below which the given fraction of sorted values fall.
+ * Param: (const double[]) values in ascending order, (int) how many, (double) fraction between 0 and 1
+ */
+double percentile(const double sortedValues[], int count, double fraction) {
+    int position = (int)ceil(fraction * count) - 1;
+    if (position < 0) {
+        position = 0;
+    }
+    return sortedValues[position];
+}
+
+/*
+ * Play a batch of games and report the guess distribution and timings.
+ * Param: (wordleSolverStruct*) the solver, (int) number of answer words to sample as secret words, 0 for all of them,
+ * (workerPoolStruct*) the worker pool, or NULL
+ */
+void runBatchBenchmark(wordleSolverStruct *solver, int sampleSize, workerPoolStruct *pool) {
+    int gameCount = solver->answerCount;
+    int *secretWords = (int *)malloc(sizeof(int) * solver->answerCount);
+    int i = 0;
+    for (; i < solver->answerCount; i++) {
+        secretWords[i] = i;
+    }
+    if (sampleSize > 0 && sampleSize < solver->answerCount) {
+        // shuffle just the first sampleSize answers into place
+        for (i = 0; i < sampleSize; i++) {
+            int other = i + rand() % (solver->answerCount - i);
+            int swap = secretWords[i];
+            secretWords[i] = secretWords[other];
+            secretWords[other] = swap;
+        }
+        gameCount = sampleSize;
+    }
+
+    double startTime = monotonicSeconds();
+    // the opening guess is shared by every game, work it out up front with the whole pool
+    if (solver->tree == NULL) {
+        solverOpeningGuess(solver);
+    }
+    double openingSeconds = monotonicSeconds() - startTime;
+
+    batchJobStruct batchJob;
+    batchJob.solver = solver;
+    batchJob.secretWords = secretWords;
+    batchJob.guessCounts = (int *)malloc(sizeof(int) * gameCount);
+    batchJob.gameSeconds = (double *)malloc(sizeof(double) * gameCount);
+    if (pool != NULL && pool->threadCount > 1) {
+        batchJob.gamePool = NULL;
+        workerPoolRun(pool, playBatchGames, &batchJob, gameCount, 1);
+    }
+    else {
+        batchJob.gamePool = pool;
+        playBatchGames(&batchJob, 0, gameCount);
+    }
+    double wallSeconds = monotonicSeconds() - startTime;
+
+    int maxGuesses = 0;
+    int failedCount = 0;
+    long long totalGuesses = 0;
+    for (i = 0; i < gameCount; i++) {
+        if (batchJob.guessCounts[i] == 0) {
+            failedCount++;
+        }
+        totalGuesses += batchJob.guessCounts[i];
+        if (batchJob.guessCounts[i] > maxGuesses) {
+            maxGuesses = batchJob.guessCounts[i];
+        }
+    }
+    int solvedCount = gameCount - failedCount;
+    printf("Played %d games on %d thread(s): %d solved, %d failed.\n", gameCount,
+           pool != NULL ? pool->threadCount : 1, solvedCount, failedCount);
+    printf("Guesses: mean %.4f, max %d\n", solvedCount > 0 ? (double)totalGuesses / solvedCount : 0.0, maxGuesses);
+    int guesses = 1;
+    for (; guesses <= maxGuesses; guesses++) {
+        int games = 0;
+        for (i = 0; i < gameCount; i++) {
+            games += batchJob.guessCounts[i] == guesses;
+        }
+        printf("  %2d guesses: %6d games (%5.1f%%)\n", guesses, games, 100.0 * games / gameCount);
+    }
+    qsort(batchJob.gameSeconds, gameCount, sizeof(double), compareDoubles);
+    printf("Wall clock: %.3f s (opening guess %.3f s), %.1f games/s\n", wallSeconds, openingSeconds,
+           gameCount / wallSeconds);
+    printf("Game latency: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           1000 * percentile(batchJob.gameSeconds, gameCount, 0.50),
+           1000 * percentile(batchJob.gameSeconds, gameCount, 0.90),
+           1000 * percentile(batchJob.gameSeconds, gameCount, 0.99),
+           1000 * batchJob.gameSeconds[gameCount - 1]);
+    free(batchJob.guessCounts);
+    free(batchJob.gameSeconds);
+    free(secretWords);
+}
+
+
+//-----------------------------------------------------------------------------------------
+// Lookahead.  Rates opening guesses by searching the guesses after them too: the value of a
+// set of candidates with d guesses left is what the best guess leaves over all feedback
+// patterns, each pattern's candidates searched again with d - 1 guesses left, and with no
+// guesses left it is what is still unsolved.  Expected mode adds up the candidates left
+// over every secret word (expectimax), worst case mode takes the largest set left (minimax).
+// Values of candidate sets are remembered in a table keyed on a hash of the set, guesses
+// are tried best first by how they split the set right away, and a guess is given up on as
+// soon as a lower bound of its value shows it cannot beat the best guess found so far.  The
+// opening guesses are spread over the worker pool.
+
+/*
+ * struct: lookaheadEntryStruct
+ * A remembered value of a set of candidates searched with some number of guesses left.
+ */
+typedef struct lookaheadEntry lookaheadEntryStruct;
+struct lookaheadEntry{
+    unsigned long long key;  // Hash of the candidates and the guesses left, 0 for an empty entry
+    long long value;         // Value of the set, or a lower bound of it
+    int exact;               // Whether value is the value, otherwise the set is worth at least value
+};
+
+/*
+ * struct: lookaheadStruct
+ * The search and what it remembers, shared by the worker pool threads searching opening guesses.
+ * Values are in whole candidates: in expected mode the sum over secret words of the candidates left with them, in
+ * worst case mode the most candidates left.
+ */
+typedef struct lookahead lookaheadStruct;
+struct lookahead{
+    const wordleSolverStruct *solver;    // The solver, for its words and feedback matrix
+    int worstCase;                       // Whether to minimize the worst case instead of the expected case
+    int width;                           // Guesses tried at each set of candidates, best first; 0 to try them all
+    lookaheadEntryStruct *memo;          // Remembered values, LOOKAHEAD_MEMO_ENTRIES of them, replaced when they collide
+    pthread_mutex_t memoLocks[ LOOKAHEAD_MEMO_LOCKS]; // Each guards the entries whose index is the same modulo the count
+    atomic_llong positions;              // Sets of candidates searched
+    atomic_llong memoHits;               // Sets whose value was remembered
+    atomic_llong pruned;                 // Guesses given up on early
+};
+
+/*
+ * Hash of a set of candidates and the guesses left, for the lookahead memo table. Two different sets hashing the same is
+ * possible but, with 64 bits, not something that happens with dictionary sized searches.
+ * Param: (const int[]) file index of each candidate, in increasing order, (int) number of candidates, (int) guesses left
+ */
+unsigned long long lookaheadKey(const int candidates[], int candidateCount, int depth) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    int i = 0;
+    for (; i < candidateCount; i++) {
+        hash = (hash ^ (unsigned int)candidates[i]) * FNV_PRIME;
+    }
+    hash = (hash ^ (unsigned long long)depth << 32) * FNV_PRIME;
+    return hash != 0 ? hash : 1;
+}
+
+/*
+ * Look up a remembered value.
+ * Param: (lookaheadStruct*) the search, (unsigned long long) key, (long long*) value, (int*) whether it is exact
+ * Output: true if the value is remembered
+ */
+int lookaheadRecall(lookaheadStruct *search, unsigned long long key, long long *value, int *exact) {
+    int slot = (int)(key & (LOOKAHEAD_MEMO_ENTRIES - 1));
+    pthread_mutex_t *lock = search->memoLocks + slot % LOOKAHEAD_MEMO_LOCKS;
+    pthread_mutex_lock(lock);
+    int found = (search->memo + slot)->key == key;
+    if (found) {
+        *value = (search->memo + slot)->value;
+        *exact = (search->memo + slot)->exact;
+    }
+    pthread_mutex_unlock(lock);
+    return found;
+}
+
+void lookaheadRemember(lookaheadStruct *search, unsigned long long key, long long value, int exact) {
+    int slot = (int)(key & (LOOKAHEAD_MEMO_ENTRIES - 1));
+    pthread_mutex_t *lock = search->memoLocks + slot % LOOKAHEAD_MEMO_LOCKS;
+    pthread_mutex_lock(lock);
+    (search->memo + slot)->key = key;
+    (search->memo + slot)->value = value;
+    (search->memo + slot)->exact = exact;
+    pthread_mutex_unlock(lock);
+}
+
+/*
+ * Lowest value a set of candidates can have. With no guesses left it is the value; with one left, guessing one of them
+ * solves it and at best leaves each other one on its own.
+ * Param: (const lookaheadStruct*) the search, (int) number of candidates, (int) guesses left
+ */
+long long lookaheadLowerBound(const lookaheadStruct *search, int candidateCount, int depth) {
+    if (depth == 0) {
+        return search->worstCase ? candidateCount : (long long)candidateCount * candidateCount;
+    }
+    if (candidateCount <= 1 || depth > 1) {
+        return 0;
+    }
+    return search->worstCase ? 1 : candidateCount - 1;
+}
+
+/*
+ * How a guess splits a set of candidates right away: its value with one guess left.
+ * Param: (const lookaheadStruct*) the search, (const int[]) the candidates, (int) how many, (int) the guess, (int[])
+ * count of each feedback pattern, all 0, left all 0, (int*) whether the guess tells any candidates apart or could be
+ * the secret word, returned by reference
+ * Output: Value of the guess with one guess left
+ */
+long long lookaheadSplitValue(const lookaheadStruct *search, const int candidates[], int candidateCount, int guess,
+                              int patternCounts[], int *splits) {
+    const feedbackMatrixStruct *matrix = search->solver->matrix;
+    const unsigned char *row = feedbackMatrixRow(matrix, guess);
+    long long value = 0;
+    int bucketCount = 0;
+    int i = 0;
+    for (; i < candidateCount; i++) {
+        int pattern = feedbackMatrixPattern(matrix, row, candidates[i]);
+        bucketCount += patternCounts[pattern] == 0;
+        patternCounts[pattern]++;
+    }
+    *splits = bucketCount > 1 || patternCounts[matrix->allGreenPattern] > 0;
+    for (i = 0; i < candidateCount; i++) {
+        int pattern = feedbackMatrixPattern(matrix, row, candidates[i]);
+        int count = patternCounts[pattern];
+        if (count > 0 && pattern != matrix->allGreenPattern) {
+            if (search->worstCase) {
+                value = count > value ? count : value;
+            }
+            else {
+                value += (long long)count * count;
+            }
+        }
+        patternCounts[pattern] = 0;
+    }
+    return value;
+}
+
+/*
+ * Sort keys in increasing order, by insertion for the few keys of small candidate sets.
+ */
+void sortLookaheadKeys(unsigned long long keys[], int count) {
+    if (count > 16) {
+        qsort(keys, count, sizeof(unsigned long long), compareUnsignedLongLong);
+        return;
+    }
+    int i = 1;
+    for (; i < count; i++) {
+        unsigned long long key = keys[i];
+        int j = i - 1;
+        for (; j >= 0 && keys[j] > key; j--) {
+            keys[j + 1] = keys[j];
+        }
+        keys[j + 1] = key;
+    }
+}
+
+long long lookaheadSearch(lookaheadStruct *search, const int candidates[], int candidateCount, int depth,
+                          long long bound);
+
+/*
+ * Value of making a guess at a set of candidates: each feedback pattern's candidates are searched with one guess less,
+ * biggest first, and the guess is given up on once it cannot come in under the bound.
+ * Param: (lookaheadStruct*) the search, (const int[]) the candidates, in increasing order, (int) how many, (int) the
+ * guess, (int) guesses left, this one included, (long long) the value to beat
+ * Output: Value of the guess if it is under the bound, otherwise a lower bound of it, at least the bound
+ */
+long long lookaheadGuessValue(lookaheadStruct *search, const int candidates[], int candidateCount, int guess, int depth,
+                              long long bound) {
+    const feedbackMatrixStruct *matrix = search->solver->matrix;
+    const unsigned char *row = feedbackMatrixRow(matrix, guess);
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    // sort the candidates by pattern, keeping them in increasing order within each pattern
+    unsigned long long *keys = (unsigned long long *)arenaAllocate(arena, sizeof(unsigned long long) * candidateCount);
+    int i = 0;
+    for (; i < candidateCount; i++) {
+        keys[i] = (unsigned long long)feedbackMatrixPattern(matrix, row, candidates[i]) << 32 | candidates[i];
+    }
+    sortLookaheadKeys(keys, candidateCount);
+    STATS_COUNT(STATS_PAIRS, candidateCount);
+    int *sorted = (int *)arenaAllocate(arena, sizeof(int) * candidateCount);
+    // bucket sizes in the high half, so sorting puts the biggest bucket last
+    unsigned long long *buckets = (unsigned long long *)arenaAllocate(arena, sizeof(unsigned long long) * candidateCount);
+    int bucketCount = 0;
+    long long lowerBound = 0;
+    i = 0;
+    while (i < candidateCount) {
+        unsigned long long pattern = keys[i] >> 32;
+        int start = i;
+        for (; i < candidateCount && keys[i] >> 32 == pattern; i++) {
+            sorted[i] = (int)(keys[i] & 0xFFFFFFFF);
+        }
+        if ((int)pattern != matrix->allGreenPattern) {
+            long long bucketBound = lookaheadLowerBound(search, i - start, depth - 1);
+            lowerBound = search->worstCase ? (bucketBound > lowerBound ? bucketBound : lowerBound) : lowerBound + bucketBound;
+            buckets[bucketCount++] = (unsigned long long)(i - start) << 32 | start;
+        }
+    }
+    if (lowerBound >= bound) {
+        atomic_fetch_add(&search->pruned, 1);
+        arenaRelease(arena, mark);
+        return lowerBound;
+    }
+    sortLookaheadKeys(buckets, bucketCount);
+    long long value = 0;
+    int b = bucketCount - 1;
+    for (; b >= 0; b--) {
+        int size = (int)(buckets[b] >> 32);
+        int start = (int)(buckets[b] & 0xFFFFFFFF);
+        long long child;
+        if (search->worstCase) {
+            child = lookaheadSearch(search, sorted + start, size, depth - 1, bound);
+            value = child > value ? child : value;
+            if (value >= bound) {
+                break;
+            }
+        }
+        else {
+            // the buckets still to search are worth at least lowerBound, so this one has to come in under the rest
+            lowerBound -= lookaheadLowerBound(search, size, depth - 1);
+            child = lookaheadSearch(search, sorted + start, size, depth - 1, bound - value - lowerBound);
+            value += child;
+            if (value + lowerBound >= bound) {
+                value += lowerBound;
+                break;
+            }
+        }
+    }
+    if (value >= bound) {
+        atomic_fetch_add(&search->pruned, 1);
+    }
+    arenaRelease(arena, mark);
+    return value;
+}
+
+/*
+ * Value of a set of candidates with some guesses left: the value of its best guess.
+ * Param: (lookaheadStruct*) the search, (const int[]) the candidates, in increasing order, (int) how many, (int) guesses
+ * left, (long long) the value to beat
+ * Output: Value of the set if it is under the bound, otherwise a lower bound of it, at least the bound
+ */
+long long lookaheadSearch(lookaheadStruct *search, const int candidates[], int candidateCount, int depth,
+                          long long bound) {
+    if (depth == 0 || candidateCount <= 1) {
+        return lookaheadLowerBound(search, candidateCount, depth);
+    }
+    if (candidateCount == 2) {
+        // guessing one of them leaves the other one alone, to be guessed next if there is a guess left
+        return depth == 1 ? 1 : 0;
+    }
+    atomic_fetch_add(&search->positions, 1);
+    unsigned long long key = lookaheadKey(candidates, candidateCount, depth);
+    long long value;
+    int exact;
+    if (lookaheadRecall(search, key, &value, &exact) && (exact || value >= bound)) {
+        atomic_fetch_add(&search->memoHits, 1);
+        return value;
+    }
+
+    const wordleSolverStruct *solver = search->solver;
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    int *patternCounts = (int *)arenaAllocate(arena, sizeof(int) * solver->matrix->patternCount);
+    memset(patternCounts, 0, sizeof(int) * solver->matrix->patternCount);
+    // guesses by how they split the candidates right away, which with one guess left is their value
+    unsigned long long *order = (unsigned long long *)arenaAllocate(arena, sizeof(unsigned long long) * solver->wordCount);
+    int orderCount = 0;
+    long long best = bound;
+    int g = 0;
+    for (; g < solver->wordCount; g++) {
+        int splits;
+        long long splitValue = lookaheadSplitValue(search, candidates, candidateCount, g, patternCounts, &splits);
+        if (depth == 1) {
+            best = splitValue < best ? splitValue : best;
+        }
+        else if (splits) {
+            order[orderCount++] = (unsigned long long)splitValue << 32 | g;
+        }
+    }
+    STATS_COUNT(STATS_PAIRS, (long long)solver->wordCount * candidateCount);
+    if (depth > 1) {
+        qsort(order, orderCount, sizeof(unsigned long long), compareUnsignedLongLong);
+        if (search->width > 0 && orderCount > search->width) {
+            orderCount = search->width;
+        }
+        long long lowestValue = lookaheadLowerBound(search, candidateCount, depth);
+        int i = 0;
+        for (; i < orderCount && best > lowestValue; i++) {
+            value = lookaheadGuessValue(search, candidates, candidateCount, (int)(order[i] & 0xFFFFFFFF), depth, best);
+            best = value < best ? value : best;
+        }
+    }
+    arenaRelease(arena, mark);
+    // no guess coming in under the bound only tells that the set is worth at least the bound
+    lookaheadRemember(search, key, best, best < bound);
+    return best;
+}
+
+/*
+ * struct: lookaheadRootStruct
+ * The opening guesses being searched by the worker pool threads, and the best values found so far.
+ */
+typedef struct lookaheadRoot lookaheadRootStruct;
+struct lookaheadRoot{
+    lookaheadStruct *search;  // The search
+    const int *candidates;    // Every answer word
+    int depth;                // Guesses searched, the opening one included
+    const int *guesses;       // Opening guesses to search, best splits first
+    long long *values;        // Value of each opening guess, or a lower bound of it if it was given up on
+    unsigned char *exact;     // Whether each value is the value of the guess
+    long long *bestValues;    // Lowest values found so far, in increasing order
+    int shownCount;           // Number of best values kept, the opening guesses to show
+    pthread_mutex_t lock;     // Guards bestValues
+};
+
+/*
+ * Worker pool job: search the opening guesses from begin to end - 1 of a lookaheadRootStruct.
+ */
+void lookaheadRootRange(void *context, int begin, int end) {
+    lookaheadRootStruct *root = (lookaheadRootStruct *)context;
+    const wordleSolverStruct *solver = root->search->solver;
+    int i = begin;
+    for (; i < end; i++) {
+        // only a value up to the worst of the best values so far gets shown, ties included
+        pthread_mutex_lock(&root->lock);
+        long long bound = root->bestValues[root->shownCount - 1];
+        pthread_mutex_unlock(&root->lock);
+        bound = bound < LLONG_MAX ? bound + 1 : bound;
+        long long value = lookaheadGuessValue(root->search, root->candidates, solver->answerCount, root->guesses[i],
+                                              root->depth, bound);
+        root->values[i] = value;
+        root->exact[i] = value < bound;
+        pthread_mutex_lock(&root->lock);
+        int position = root->shownCount - 1;
+        if (value < root->bestValues[position]) {
+            for (; position > 0 && root->bestValues[position - 1] > value; position--) {
+                root->bestValues[position] = root->bestValues[position - 1];
+            }
+            root->bestValues[position] = value;
+        }
+        pthread_mutex_unlock(&root->lock);
+    }
+}
+
+/*
+ * Search the opening guesses with lookahead and list the best of them.
+ * Param: (const wordleSolverStruct*) the solver, (int) guesses to look ahead, the opening one included, (int) whether
+ * to minimize the worst case instead of the expected case, (int) guesses tried at each set of candidates, 0 for all,
+ * (int) number of opening guesses to list, (workerPoolStruct*) the worker pool, or NULL
+ */
+void runLookahead(const wordleSolverStruct *solver, int depth, int worstCase, int width, int shownCount,
+                  workerPoolStruct *pool) {
+    double startTime = monotonicSeconds();
+    STATS_START(timer);
+    lookaheadStruct search;
+    search.solver = solver;
+    search.worstCase = worstCase;
+    search.width = width;
+    search.memo = (lookaheadEntryStruct *)calloc(LOOKAHEAD_MEMO_ENTRIES, sizeof(lookaheadEntryStruct));
+    int i = 0;
+    for (; i < LOOKAHEAD_MEMO_LOCKS; i++) {
+        pthread_mutex_init(search.memoLocks + i, NULL);
+    }
+    atomic_init(&search.positions, 0);
+    atomic_init(&search.memoHits, 0);
+    atomic_init(&search.pruned, 0);
+
+    int *candidates = (int *)malloc(sizeof(int) * solver->answerCount);
+    for (i = 0; i < solver->answerCount; i++) {
+        candidates[i] = i;
+    }
+    // opening guesses best splits first, so the first ones searched set a low bound for the others
+    int *patternCounts = (int *)calloc(solver->matrix->patternCount, sizeof(int));
+    unsigned long long *order = (unsigned long long *)malloc(sizeof(unsigned long long) * solver->wordCount);
+    int g = 0;
+    for (; g < solver->wordCount; g++) {
+        int splits;
+        long long splitValue = lookaheadSplitValue(&search, candidates, solver->answerCount, g, patternCounts, &splits);
+        order[g] = (unsigned long long)splitValue << 32 | g;
+    }
+    STATS_COUNT(STATS_PAIRS, (long long)solver->wordCount * solver->answerCount);
+    qsort(order, solver->wordCount, sizeof(unsigned long long), compareUnsignedLongLong);
+    int guessCount = width > 0 && width < solver->wordCount ? width : solver->wordCount;
+    int *guesses = (int *)malloc(sizeof(int) * guessCount);
+    for (i = 0; i < guessCount; i++) {
+        guesses[i] = (int)(order[i] & 0xFFFFFFFF);
+    }
+
+    lookaheadRootStruct root;
+    root.search = &search;
+    root.candidates = candidates;
+    root.depth = depth;
+    root.guesses = guesses;
+    root.values = (long long *)malloc(sizeof(long long) * guessCount);
+    root.exact = (unsigned char *)malloc(guessCount);
+    root.shownCount = shownCount < guessCount ? shownCount : guessCount;
+    root.bestValues = (long long *)malloc(sizeof(long long) * root.shownCount);
+    for (i = 0; i < root.shownCount; i++) {
+        root.bestValues[i] = LLONG_MAX;
+    }
+    pthread_mutex_init(&root.lock, NULL);
+    workerPoolRun(pool, lookaheadRootRange, &root, guessCount, 1);
+
+    // the opening guesses with the best values, ties in alphabetical order
+    long long shownBound = root.bestValues[root.shownCount - 1];
+    int shown = 0;
+    for (i = 0; i < guessCount; i++) {
+        if (root.exact[i] && root.values[i] <= shownBound) {
+            order[shown++] = (unsigned long long)root.values[i] << 32 | guesses[i];
+        }
+    }
+    qsort(order, shown, sizeof(unsigned long long), compareUnsignedLongLong);
+    for (i = 1; i < shown; i++) {
+        unsigned long long entry = order[i];
+        int j = i - 1;
+        for (; j >= 0 && order[j] >> 32 == entry >> 32
+               && strcmp((solver->allWords + (int)(order[j] & 0xFFFFFFFF))->word,
+                         (solver->allWords + (int)(entry & 0xFFFFFFFF))->word) > 0; j--) {
+            order[j + 1] = order[j];
+        }
+        order[j + 1] = entry;
+    }
+    printf("Best opening guesses looking %d guesses ahead, by %s, trying %s:\n", depth,
+           worstCase ? "most candidates left" : "expected candidates left",
+           width > 0 ? "the best splits only" : "every guess");
+    for (i = 0; i < shown && i < root.shownCount; i++) {
+        long long value = (long long)(order[i] >> 32);
+        printf("%s %.4f\n", (solver->allWords + (int)(order[i] & 0xFFFFFFFF))->word,
+               worstCase ? (double)value : (double)value / solver->answerCount);
+    }
+    STATS_STOP(timer, STATS_LOOKAHEAD);
+    printf("Searched %lld candidate sets (%lld remembered), gave up early on %lld guesses, in %.3f s.\n",
+           (long long)atomic_load(&search.positions), (long long)atomic_load(&search.memoHits),
+           (long long)atomic_load(&search.pruned), monotonicSeconds() - startTime);
+
+    pthread_mutex_destroy(&root.lock);
+    free(root.values);
+    free(root.exact);
+    free(root.bestValues);
+    free(guesses);
+    free(order);
+    free(patternCounts);
+    free(candidates);
+    for (i = 0; i < LOOKAHEAD_MEMO_LOCKS; i++) {
+        pthread_mutex_destroy(search.memoLocks + i);
+    }
+    free(search.memo);
+}
+
+//-----------------------------------------------------------------------------------------
+// Worst case analysis.  Gives guarantees for opening guesses instead of averages: the
+// answer words are partitioned by the feedback pattern of the opening, and each bucket is
+// played out against every answer word in it, each time guessing the word that leaves the
+// fewest candidates in the worst case (the smallest biggest bucket).  Following that, every
+// answer word is solved within the reported number of guesses, and after each guess no more
+// than the reported number of candidates is left.  A partition is an array of keys, the
+// pattern in the high half and the answer word in the low half, sorted so each bucket is a
+// run of it.  The openings are partitioned a batch at a time, then all of their buckets are
+// played out over the worker pool, so even a single opening keeps every thread busy.
+
+/*
+ * struct: worstCaseStruct
+ * Worst case of a bucket of answer words, or of all buckets of an opening guess.
+ */
+typedef struct worstCase worstCaseStruct;
+struct worstCase{
+    int guesses;                       // Guesses to solve every answer word, the opening included
+    int mostLeft[ WORST_CASE_LEVELS];  // Most answer words still possible after each guess, 0 once all are solved
+};
 
-int compareFunctionLetter( const void * a, const void * b) {
-    // Before using parameters we have cast them into the actual type they are in our program
-    // and then extract the numerical value used in comparison
-    int firstScore = ((letterCountStruct *) a)->appearances;
-    int secondScore = ((letterCountStruct *) b)->appearances;
+/*
+ * struct: worstCaseAnalysisStruct
+ * A batch of opening guesses being analyzed, shared by the worker pool threads.
+ */
+typedef struct worstCaseAnalysis worstCaseAnalysisStruct;
+struct worstCaseAnalysis{
+    const feedbackMatrixStruct *matrix;  // Feedback of every word against every answer word
+    int wordCount;                       // Number of words that can be guessed
+    const int *openings;                 // File index of each opening guess of the batch
+    unsigned long long *partitions;      // Partition of the answer words by each opening, answerCount keys each
+    int *bucketStarts;                   // Start of each bucket of the batch in partitions
+    int *bucketSizes;                    // Number of answer words in each bucket
+    worstCaseStruct *bucketWorstCases;   // Worst case of each bucket
+};
 
-    // If scores are different, then that's all we need for our comparison.
-    if (firstScore != secondScore) {
-        // We reverse the values, so the result is in descending vs. the otherwise ascending order
-        // return firstScore - secondScore;   // ascending order
-        return secondScore - firstScore;      // descending order
-    }
-    else {
-        // Scores are equal, so check words themselves, to put them in alphabetical order
-        return strcmp( ((letterCountStruct *) a)->letter,  ((letterCountStruct *) b)->letter );
+/*
+ * Guess that leaves the fewest candidates in the worst case: the one whose biggest feedback bucket is smallest. On a
+ * tie, a guess that could be the secret word is preferred, then the first word of the file. A guess is given up on as
+ * soon as one of its buckets shows it cannot beat the best guess so far.
+ * Param: (const worstCaseAnalysisStruct*) the analysis, (const int[]) file index of each candidate, in increasing
+ * order, (int) how many, (int[]) count of each feedback pattern, all 0, left all 0
+ * Output: File index of the guess
+ */
+int worstCaseGuess(const worstCaseAnalysisStruct *analysis, const int candidates[], int candidateCount,
+                   int patternCounts[]) {
+    const feedbackMatrixStruct *matrix = analysis->matrix;
+    int bestGuess = -1;
+    int bestLargest = candidateCount + 1;
+    int bestIsCandidate = false;
+    int nextCandidate = 0;
+    long long pairs = 0;
+    int g = 0;
+    for (; g < analysis->wordCount; g++) {
+        // the guesses are tried in file order, the same order as the candidates
+        while (nextCandidate < candidateCount && candidates[nextCandidate] < g) {
+            nextCandidate++;
+        }
+        int isCandidate = nextCandidate < candidateCount && candidates[nextCandidate] == g;
+        // a guess only beats the best so far with a smaller biggest bucket, or the same one and being a candidate
+        int largestToBeat = isCandidate && !bestIsCandidate ? bestLargest : bestLargest - 1;
+        const unsigned char *row = feedbackMatrixRow(matrix, g);
+        int largest = 0;
+        int i = 0;
+        for (; i < candidateCount && largest <= largestToBeat; i++) {
+            int pattern = feedbackMatrixPattern(matrix, row, candidates[i]);
+            int count = ++patternCounts[pattern];
+            if (count > largest && pattern != matrix->allGreenPattern) {
+                largest = count;
+            }
+        }
+        pairs += i;
+        int j = 0;
+        for (; j < i; j++) {
+            patternCounts[feedbackMatrixPattern(matrix, row, candidates[j])] = 0;
+        }
+        if (largest <= largestToBeat) {
+            bestGuess = g;
+            bestLargest = largest;
+            bestIsCandidate = isCandidate;
+        }
     }
-} //end compareFunction(..)
+    STATS_COUNT(STATS_PAIRS, pairs);
+    STATS_COUNT(STATS_GUESSES, 1);
+    return bestGuess;
+}
 
 /*
- * Copy an array of wordCountStruct, in particular, a dynamically allocated array, granted the size is known (or specifically,
- * the first amount of objects to be copied is known)
- * Param: (wordCountStruct*) source array of wordCountStruct to copy from (a pointer copy), (int) how many first
- * wordCountStruct objects to be copied from the source array.
- * Output: Return the pointer to the dynamically allocated memory of the array post-copying.
+ * Play out a set of candidates against every secret word in it, guessing with worstCaseGuess(..), and add its worst
+ * case to a worst case.
+ * Param: (const worstCaseAnalysisStruct*) the analysis, (const int[]) file index of each candidate, in increasing
+ * order, (int) how many, (int) guesses made so far, (int[]) count of each feedback pattern, all 0, left all 0,
+ * (worstCaseStruct*) worst case to add to
  */
-wordCountStruct *wordStructArrayCopy(wordCountStruct *src, int size) {
+void worstCaseOfCandidates(const worstCaseAnalysisStruct *analysis, const int candidates[], int candidateCount,
+                           int guessesMade, int patternCounts[], worstCaseStruct *worstCase) {
+    if (guessesMade <= WORST_CASE_LEVELS && candidateCount > worstCase->mostLeft[guessesMade - 1]) {
+        worstCase->mostLeft[guessesMade - 1] = candidateCount;
+    }
+    if (candidateCount <= 2) {
+        // guessing one of them leaves the other one alone, to be guessed next
+        if (candidateCount == 2 && guessesMade < WORST_CASE_LEVELS && worstCase->mostLeft[guessesMade] < 1) {
+            worstCase->mostLeft[guessesMade] = 1;
+        }
+        if (guessesMade + candidateCount > worstCase->guesses) {
+            worstCase->guesses = guessesMade + candidateCount;
+        }
+        return;
+    }
+    const feedbackMatrixStruct *matrix = analysis->matrix;
+    int guess = worstCaseGuess(analysis, candidates, candidateCount, patternCounts);
+    const unsigned char *row = feedbackMatrixRow(matrix, guess);
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    // partition the candidates by pattern, keeping them in increasing order within each pattern
+    unsigned long long *keys = (unsigned long long *)arenaAllocate(arena, sizeof(unsigned long long) * candidateCount);
     int i = 0;
-    wordCountStruct *dest;
-    // malloc was used here, must free after this copying if used elsewhere
-    // than main (in which frees are automatically called, but should be called for good practice).
-    dest = (wordCountStruct *)malloc(sizeof(wordCountStruct) * size);
-    for (; i < size; i++) {
-        // to copy wordCountStruct is to create another object with its variables - word and score, being the same as the source.
-        strcpy((dest + i)->word, (src + i)->word);
-        (dest + i)->score = (src + i)->score;
+    for (; i < candidateCount; i++) {
+        keys[i] = (unsigned long long)feedbackMatrixPattern(matrix, row, candidates[i]) << 32 | candidates[i];
+    }
+    sortLookaheadKeys(keys, candidateCount);
+    STATS_COUNT(STATS_PAIRS, candidateCount);
+    int *bucket = (int *)arenaAllocate(arena, sizeof(int) * candidateCount);
+    i = 0;
+    while (i < candidateCount) {
+        unsigned long long pattern = keys[i] >> 32;
+        int size = 0;
+        for (; i < candidateCount && keys[i] >> 32 == pattern; i++) {
+            bucket[size++] = (int)(keys[i] & 0xFFFFFFFF);
+        }
+        if ((int)pattern == matrix->allGreenPattern) {
+            if (guessesMade + 1 > worstCase->guesses) {
+                worstCase->guesses = guessesMade + 1;
+            }
+        }
+        else {
+            worstCaseOfCandidates(analysis, bucket, size, guessesMade + 1, patternCounts, worstCase);
+        }
     }
-    return dest;
+    arenaRelease(arena, mark);
 }
 
-//-----------------------------------------------------------------------------------------
-// Read in words from file into array.  We've previously read the data file once to
-// find out how many words are in the file.
-void readWordsFromFile(
-        char fileName[],        // Filename we'll read from
-        wordCountStruct *words, // Array of words where we'll store words we read from file
-        int *wordCount)          // How many words.  Gets updated here and returned
-{
-    FILE *inFilePtr  = fopen(fileName, "r");  // Connect logical name to filename
-    assert( inFilePtr != NULL);               // Ensure file open worked correctly
-
-    // Read each word from file and store into array, initializing the score for that word to 0.
-    char inputString[ 6];
-    *wordCount = 0;
-    while( fscanf( inFilePtr, "%s", inputString) != EOF) {
-        strcpy( words[ *wordCount].word, inputString);
-        words[ *wordCount].score = 0;
-        (*wordCount)++;
+/*
+ * Worker pool job: partition the answer words by the feedback of the opening guesses from begin to end - 1 of a
+ * worstCaseAnalysisStruct.
+ */
+void worstCasePartitionRange(void *context, int begin, int end) {
+    worstCaseAnalysisStruct *analysis = (worstCaseAnalysisStruct *)context;
+    const feedbackMatrixStruct *matrix = analysis->matrix;
+    int i = begin;
+    for (; i < end; i++) {
+        const unsigned char *row = feedbackMatrixRow(matrix, analysis->openings[i]);
+        unsigned long long *keys = analysis->partitions + (size_t)i * matrix->answerCount;
+        int a = 0;
+        for (; a < matrix->answerCount; a++) {
+            keys[a] = (unsigned long long)feedbackMatrixPattern(matrix, row, a) << 32 | a;
+        }
+        sortLookaheadKeys(keys, matrix->answerCount);
+        STATS_COUNT(STATS_PAIRS, matrix->answerCount);
     }
+}
 
-    // Close the file
-    fclose( inFilePtr);
-} // end readWordsFromFile(..)
-
-void scoreReset(wordCountStruct allWords[], int counter) {
-    int i = 0;
-    for (; i < counter; i++) {
-        (allWords+i)->score = 0;
+/*
+ * Worker pool job: play out the buckets from begin to end - 1 of a worstCaseAnalysisStruct.
+ */
+void worstCaseBucketRange(void *context, int begin, int end) {
+    worstCaseAnalysisStruct *analysis = (worstCaseAnalysisStruct *)context;
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    int *patternCounts = (int *)arenaAllocate(arena, sizeof(int) * analysis->matrix->patternCount);
+    memset(patternCounts, 0, sizeof(int) * analysis->matrix->patternCount);
+    int b = begin;
+    for (; b < end; b++) {
+        size_t bucketMark = arena->used;
+        int size = analysis->bucketSizes[b];
+        int *candidates = (int *)arenaAllocate(arena, sizeof(int) * size);
+        int i = 0;
+        for (; i < size; i++) {
+            candidates[i] = (int)(analysis->partitions[analysis->bucketStarts[b] + i] & 0xFFFFFFFF);
+        }
+        memset(analysis->bucketWorstCases + b, 0, sizeof(worstCaseStruct));
+        worstCaseOfCandidates(analysis, candidates, size, 1, patternCounts, analysis->bucketWorstCases + b);
+        arenaRelease(arena, bucketMark);
     }
-    qsort(allWords, counter, sizeof(wordCountStruct), compareFunction);
+    arenaRelease(arena, mark);
 }
 
 /*
- * Take a word of reference and a word that is choice of guess, assign score to how well-matched the guess word was
- * to the reference word. With proper precedent,
- * assign 3 points to a perfectly matched letter of the same position
- * after assigning all the 3-point possible, assign 1 point if there exists letters matching (at this point, letters are
- * guaranteed to not be of the same location, so 1-point assignment well-defined).
- * Param: (char*) word of reference to calculate score on, (char*) word that is guessing to be compared to word of reference
- * Output: Score of guess word relative to the reference word.
+ * Analyze the worst case of opening guesses and print, for each of them, its biggest buckets of answer words, the
+ * most answer words left after each guess and the guesses it takes to solve every answer word.
+ * Param: (const feedbackMatrixStruct*) feedback matrix of all words, answer words first, (const wordStoreStruct*) store
+ * of the same words in the same order, with the scores to show, (const int[]) index of each opening guess, (int) how
+ * many, (workerPoolStruct*) the worker pool, or NULL
  */
-int scoreAssigning(char *wordRef, char *wordGuess) {
-    int scoreAssigned = 0;
-    int k = 0;
-    // first assign the 3-points, match index by index of string, then blank out to indicate the letter not to be counted for
-    // for the loop assigning 1-points.
-    for (; k < 5; k++) {
-        if (wordGuess[k] == wordRef[k]) {
-            scoreAssigned += 3;
-            // blanking out used different letters to differentiate (the guess word's 'letter' should not still be found)
-            wordRef[k] = ' ';
-            wordGuess[k] = '-';
+void runWorstCaseAnalysis(const feedbackMatrixStruct *matrix, const wordStoreStruct *store, const int openings[],
+                          int openingCount, workerPoolStruct *pool) {
+    double startTime = monotonicSeconds();
+    STATS_START(timer);
+    int answerCount = matrix->answerCount;
+    int batchSize = openingCount < WORST_CASE_BATCH_SIZE ? openingCount : WORST_CASE_BATCH_SIZE;
+    worstCaseAnalysisStruct analysis;
+    analysis.matrix = matrix;
+    analysis.wordCount = matrix->guessCount;
+    analysis.partitions = (unsigned long long *)malloc(sizeof(unsigned long long) * ((size_t)batchSize * answerCount + 1));
+    // an opening has at most one bucket per answer word
+    analysis.bucketStarts = (int *)malloc(sizeof(int) * ((size_t)batchSize * answerCount + 1));
+    analysis.bucketSizes = (int *)malloc(sizeof(int) * ((size_t)batchSize * answerCount + 1));
+    analysis.bucketWorstCases = (worstCaseStruct *)malloc(sizeof(worstCaseStruct) * ((size_t)batchSize * answerCount + 1));
+    int *firstBuckets = (int *)malloc(sizeof(int) * (batchSize + 1));
+    int bestGuesses = INT_MAX;
+    int bestCount = 0;
+    int batchStart = 0;
+    for (; batchStart < openingCount; batchStart += batchSize) {
+        int batchCount = openingCount - batchStart < batchSize ? openingCount - batchStart : batchSize;
+        analysis.openings = openings + batchStart;
+        workerPoolRun(pool, worstCasePartitionRange, &analysis, batchCount, 1);
+        // each run of the same pattern in a partition is a bucket, the all green one is solved by the opening
+        int bucketCount = 0;
+        int o = 0;
+        for (; o < batchCount; o++) {
+            firstBuckets[o] = bucketCount;
+            int start = o * answerCount;
+            int i = start;
+            while (i < start + answerCount) {
+                unsigned long long pattern = analysis.partitions[i] >> 32;
+                int bucketStart = i;
+                while (i < start + answerCount && analysis.partitions[i] >> 32 == pattern) {
+                    i++;
+                }
+                if ((int)pattern != matrix->allGreenPattern) {
+                    analysis.bucketStarts[bucketCount] = bucketStart;
+                    analysis.bucketSizes[bucketCount] = i - bucketStart;
+                    bucketCount++;
+                }
+            }
         }
-    }
-    k = 0; // double loop since precise location should take precedent, no
-    // way to ensure that if implementing parallelly
-    for (; k < 5; k++) {
-        if (strchr(wordRef, wordGuess[k])) {
-            scoreAssigned += 1;
-            *(strchr(wordRef, wordGuess[k])) = ' ';
-            // don't need to blank pos k of guess word since this is
-            // the last time it is encountered.
+        firstBuckets[batchCount] = bucketCount;
+        workerPoolRun(pool, worstCaseBucketRange, &analysis, bucketCount, 1);
+
+        for (o = 0; o < batchCount; o++) {
+            int opening = analysis.openings[o];
+            worstCaseStruct worstCase;
+            memset(&worstCase, 0, sizeof(worstCase));
+            // the opening solves itself if it is an answer word
+            worstCase.guesses = opening < answerCount ? 1 : 0;
+            int biggest[ WORST_CASE_BUCKETS_SHOWN];
+            int biggestCount = 0;
+            int b = firstBuckets[o];
+            for (; b < firstBuckets[o + 1]; b++) {
+                const worstCaseStruct *bucketWorstCase = analysis.bucketWorstCases + b;
+                worstCase.guesses = bucketWorstCase->guesses > worstCase.guesses ? bucketWorstCase->guesses
+                                                                                 : worstCase.guesses;
+                int level = 0;
+                for (; level < WORST_CASE_LEVELS; level++) {
+                    if (bucketWorstCase->mostLeft[level] > worstCase.mostLeft[level]) {
+                        worstCase.mostLeft[level] = bucketWorstCase->mostLeft[level];
+                    }
+                }
+                // keep the biggest bucket sizes in decreasing order
+                int size = analysis.bucketSizes[b];
+                if (biggestCount < WORST_CASE_BUCKETS_SHOWN || size > biggest[WORST_CASE_BUCKETS_SHOWN - 1]) {
+                    int position = biggestCount < WORST_CASE_BUCKETS_SHOWN ? biggestCount++ : WORST_CASE_BUCKETS_SHOWN - 1;
+                    for (; position > 0 && biggest[position - 1] < size; position--) {
+                        biggest[position] = biggest[position - 1];
+                    }
+                    biggest[position] = size;
+                }
+            }
+            int patternCount = firstBuckets[o + 1] - firstBuckets[o] + (opening < answerCount);
+            printf("%.*s %d\n", store->wordLength, storedWord(store, opening), store->scores[opening]);
+            printf("   %d patterns, biggest buckets:", patternCount);
+            int i = 0;
+            for (; i < biggestCount; i++) {
+                printf(" %d", biggest[i]);
+            }
+            printf("\n   most answers left after guess");
+            for (i = 0; i < WORST_CASE_LEVELS && worstCase.mostLeft[i] > 0; i++) {
+                printf("%s %d: %d", i > 0 ? "," : "", i + 1, worstCase.mostLeft[i]);
+            }
+            printf("\n   solves every answer within %d guesses\n", worstCase.guesses);
+            if (worstCase.guesses < bestGuesses) {
+                bestGuesses = worstCase.guesses;
+                bestCount = 0;
+            }
+            bestCount += worstCase.guesses == bestGuesses;
         }
     }
-    return scoreAssigned;
+    STATS_STOP(timer, STATS_WORST_CASE);
+    if (openingCount > 1) {
+        printf("Best guarantee: every answer within %d guesses, with %d of the %d openings.\n", bestGuesses, bestCount,
+               openingCount);
+    }
+    printf("Analyzed %d opening guess%s in %.3f s.\n", openingCount, openingCount == 1 ? "" : "es",
+           monotonicSeconds() - startTime);
+    free(analysis.partitions);
+    free(analysis.bucketStarts);
+    free(analysis.bucketSizes);
+    free(analysis.bucketWorstCases);
+    free(firstBuckets);
 }
 
+// -----------------------------------------------------------------------------------------
+// Solver server.  Loads the dictionary and its tables once, then answers requests from
+// clients over stdin/stdout or a Unix socket, one request per line:
+//     guess [WORD FEEDBACK]...   the solver's next guess after the guesses so far, with the
+//                                number of candidates left
+//     filter [WORD FEEDBACK]...  the candidates left after the guesses so far
+//     score WORD...              the 3/1 point score of each word against all answer words
+//     quit                       stop the server
+// FEEDBACK has a digit per letter: 0 for grey, 1 for yellow, 2 for green.  Requests come in
+// batches that end with an empty line (or the end of the input); the requests of a batch
+// are handled at the same time on the worker pool, then answered in order, each answer
+// starting with "ok" or "error" and the microseconds it took, followed by a "batch" line
+// with the count and timings of the batch and an empty line.
+
 /*
- * Compute scores of however many words indicated by size, starting from a certain word in the wordCountStruct array.
- * Scores are computed relative to the array of answers (with a specified amount of answers of consideration).
- * Param: (wordCountStruct*) the pointer at the beginning of the wordCountStruct array in consideration for score assignment
- * (wordCountStruct*) the pointer at the beginning of the array of answers to compare all words to for scores, (int)
- * amount of answer words of consideration, (int) amount of words to have scores computed
+ * struct: serverStateStruct
+ * Everything the server works out once and reuses for every request.
  */
-void scoreCompute(wordCountStruct *begin, wordCountStruct *answerBegin,
-                  int answersCounter, int size) {
-    int i = 0;
-    for (; i < size; i++) {
-        int j = 0;
-        int pointAccumulated = 0;
-        for (; j < answersCounter; j++) {
-            // the process of computing scores demand mutating the words, but since a word is computed scores multiple times,
-            // the words should not be permanently mutated, so operate this score assigning on a copy of the answer/guess word instead.
-            char wordOfReference[6];
-            char wordOfCurrentGuess[6];
-            strcpy(wordOfReference, (answerBegin+j)->word);
-            strcpy(wordOfCurrentGuess, begin->word);
-            // score of a wordCountStruct is defined to be the sum of all its scores relative to the answerWord.
-            pointAccumulated += scoreAssigning(wordOfReference, wordOfCurrentGuess);
-        }
-        begin->score = pointAccumulated;
-        begin++;
-    }
-}
-
-/*
- * In consideration of the second best words, the words in the array of answerWords are mutated: the letters are blanked
- * out; thus, the function first creates a copy of the answerWords, modify the words of this copy array based on which word
- * meant to be used as a blanking out. Afterwards, utilize the score computing function to finish the rest.
- * Param: (wordCountStruct*) the pointer at the beginning of the wordCountStruct array in consideration for score assignment
- * (wordCountStruct*) the pointer at the beginning of the array of answers to compare all words to for scores, (int)
- * amount of answer words of consideration, (int) amount of words to have scores computed, (char[]) string of the word based upon which
- * to blank out all the answersWord from.
- */
-void secondScoreCompute(wordCountStruct *begin, wordCountStruct *answerBegin,
-                        int answersCounter, int size, char wordToRemove[]) {
-    wordCountStruct* filteredWordArray = wordStructArrayCopy(answerBegin, answersCounter);
-    int i = 0;
-    char cpyRemoveWord[6]; //score assigning function applies onto char array, which is forced as pass by reference (due to array construction), so require a copy to not completely mutate
-    for (; i < answersCounter; i ++) {
-        strcpy(cpyRemoveWord, wordToRemove);
-        // this function is less about assigning score, but more so to mutate the words (blanking letters)
-        scoreAssigning((filteredWordArray + i)->word, cpyRemoveWord);
-//        printf(" %d. %s\n", i, (filteredWordArray + i)->word); // debug: print all the words post-blanking
+typedef struct serverState serverStateStruct;
+struct serverState{
+    wordleSolverStruct *solver;          // The solver, with its opening guess worked out
+    packedAnswersStruct packedAnswers;   // The answer words packed once, for score requests
+    int *wordsInOrder;                   // File index of every word, in alphabetical order, to look words up
+};
+
+/*
+ * struct: serverRequestStruct
+ * One request of a batch and its answer.
+ */
+typedef struct serverRequest serverRequestStruct;
+struct serverRequest{
+    char *line;               // The request, split up in place while it is handled
+    char *response;           // The answer, without the status and timing
+    size_t responseLength;    // Length of the answer
+    size_t responseCapacity;  // Room allocated for the answer
+    int failed;               // Whether the answer is an error message
+    double seconds;           // How long handling the request took
+};
+
+/*
+ * Add text to the answer of a request, printf style.
+ * Param: (serverRequestStruct*) the request, (const char*) format, then the values for it
+ */
+void appendResponse(serverRequestStruct *request, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+    if (request->responseLength + length + 1 > request->responseCapacity) {
+        while (request->responseLength + length + 1 > request->responseCapacity) {
+            request->responseCapacity = request->responseCapacity < 64 ? 64 : request->responseCapacity * 2;
+        }
+        request->response = (char *)realloc(request->response, request->responseCapacity);
     }
-    // compute the scores, assigning scores to each word in the word bank based on answersWords that are already blanked out at this point
-    scoreCompute(begin, filteredWordArray, answersCounter, size);
-    free(filteredWordArray);
+    va_start(arguments, format);
+    vsnprintf(request->response + request->responseLength, length + 1, format, arguments);
+    va_end(arguments);
+    request->responseLength += length;
 }
 
 /*
- * Composite function to parse answers, guesses from fileNames indicated, calculate how many answersWords and guessesWords are,
- * initialize the array of all wordCountStruct objects as well as just the answerWords wordCountStruct. Afterwards, immediately
- * calculate the best first word to guess, assigning scores to each of the word in the array of all words and sort based on score/alphabetically.
- * Param: (char[]) file name of all answer words, (int*) integer passed by reference to indicate how many answerWords there are,
- * (char[]) file name of all guess words, (int*) integer passed by reference to indicate how many guessesWords there are,
- * (wordCountStruct**) the pointer to the first object of the dynamically allocated array of all wordCountStruct objects
- * passed in by reference, (wordCountStruct**) the pointer to the first object of all answer words wordCountStruct objects.
+ * Turn a request into an error answer, dropping anything answered so far.
+ * Param: (serverRequestStruct*) the request, (const char*) the error message
  */
-void parseAndCompute(wordCountStruct** allWords, int* answersCounter, int* guessesCounter, wordCountStruct** allAnswers) {
-    // the space reserved for guesses in the array of all words start after all answers
-    // as a consequence, all answer words are meant to belong in the first [amount of answerWords] objects of the array
-    // save a copy of the answer words for later usage.
-    (*allAnswers) = wordStructArrayCopy(*allWords, *answersCounter);
-    scoreCompute(*allWords, *allWords, *answersCounter,
-                 *answersCounter + *guessesCounter);
-    // Sort the allWords array in descending order by score, and within score they
-    // should also be sorted into ascending order alphabetically.  Use the built-in
-    // C quick sort qsort(...).
-    qsort(*allWords, *guessesCounter + *answersCounter, sizeof(wordCountStruct),
-          compareFunction);
+void failRequest(serverRequestStruct *request, const char *message) {
+    request->responseLength = 0;
+    request->failed = true;
+    appendResponse(request, "%s", message);
 }
 
 /*
- * Process which word is the best second word post-first best word computation. Extract all the highest scored words,
- * process second-best words in the same manner as the first-best word, but based on the answer words that had letters
- * struck out from the highest scored words, instead of full answer words.
- * Param: (wordCountStruct**) the pointer to the first object of the dynamically allocated array of all wordCountStruct objects
- * passed in by reference, which at this point is sorted based on scores relative to full-letter answerr words,
- * (wordCountStruct**) the pointer to the first object of all answer words wordCountStruct objects, (int) count of all
- * answer words, (int) count of all guess words.
- */
-void bestSecondWordsProcessing(wordCountStruct** allWords, wordCountStruct** allAnswers, int answersCounter, int guessesCounter) {
-    // first extract all the highest scored words, separate it into a specific array, since the array of all words
-    // are going to be mutated after the consideration with the first highest scoring word.
-    int highestScore = (*allWords)->score;
-    int highestScoredWordsTie = 0;
-    while ((*allWords + highestScoredWordsTie)->score == highestScore) {
-        highestScoredWordsTie++;
-    }
-    wordCountStruct* highestScoredWords = wordStructArrayCopy(*allWords, highestScoredWordsTie);
-    int i = 0;
+ * Sort order of word file indexes by their words, for the server's word lookup.
+ */
+static const wordCountStruct *serverWordsToSort;
+int compareWordIndexes(const void *a, const void *b) {
+    return strcmp((serverWordsToSort + *(const int *)a)->word, (serverWordsToSort + *(const int *)b)->word);
+}
 
-    while (i < highestScoredWordsTie) {
-        /* Debug:
-        printf("answerWordsCopy after letters from %s removed:\n",
-               (highestScoredWords + i)->word);
-         */
-        // compute score (second compute score) based on what word to blank out, then sort afterwards with now new scores assigned
-        // relative to the answer words array, assumed to have letters struck out.
-        secondScoreCompute(*allWords, *allAnswers, answersCounter, answersCounter + guessesCounter, (highestScoredWords + i)->word);
-        qsort(*allWords, guessesCounter + answersCounter, sizeof(wordCountStruct),
-              compareFunction);
-        int j = 0;
-        /* Debug: Words and their scores relative to the answer words that were blanked out by the best first word
-        for (; j < answersCounter + guessesCounter; j++) {
-            printf("    %s %d\n", (*allWords + j)->word, (*allWords + j)->score);
+/*
+ * Look up a word of the dictionary.
+ * Param: (const serverStateStruct*) the server, (const char[]) the word
+ * Output: File index of the word, or -1 if it is not in the dictionary
+ */
+int findServerWord(const serverStateStruct *server, const char word[]) {
+    int low = 0;
+    int high = server->solver->wordCount - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        int index = server->wordsInOrder[middle];
+        int order = strcmp((server->solver->allWords + index)->word, word);
+        if (order == 0) {
+            return index;
         }
-         */
-        printf("%s %d\n", (highestScoredWords + i)->word, highestScore);
-        int highestSecondWordScore = (*allWords)->score;
-        j = 0;
-        while (((*allWords) + j)->score == highestSecondWordScore) {
-            printf("   %s %d", ((*allWords) + j)->word, highestSecondWordScore);
-            j++;
+        if (order < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle - 1;
         }
-        printf("\n");
-        i++;
     }
-    free(highestScoredWords);
+    return -1;
 }
 
-// -----------------------------------------------------------------------------------------
-
-int main2() {
-    char answersFileName[81]; // Stores the answers file name
-    char guessesFileName[81]; // Stores the guesses file name
-    int answersCounter = 0;
-    int guessesCounter = 0;
-    // Set default file names
-    // ...
-    // Construct containers for all words, both guesses and answers, and all answers, for later usage of blanking out letters of answers based on "best first words"
-    wordCountStruct *allWords;
-    wordCountStruct *allAnswers;
-    // Read in the file, count answers and guesses words, parse into the array of structs and assign scores,
-    // compute best first word(s), turn array of all words into sorted order and save a copy of the answer words.
-    parseAndCompute(answersFileName, &answersCounter, guessesFileName, &guessesCounter, &allWords, &allAnswers);
-    printf("%s has %d words\n%s has %d words\n", answersFileName, answersCounter, guessesFileName, guessesCounter);
-    printf("\nWords and scores for top first words and second words:\n");
-    // if option 2, re-process the allWords array based on the best first words
-    bestSecondWordsProcessing(&allWords, &allAnswers, answersCounter, guessesCounter);
-    free(allWords);
-    free(allAnswers);
-    printf("Done\n");
-    return 0;
-} // end main()
+/*
+ * Read a feedback pattern written as a digit per letter.
+ * Param: (const char[]) the feedback, (int) length of the words
+ * Output: Feedback pattern number, or -1 if the feedback is not wordLength digits 0, 1 or 2
+ */
+int parseFeedback(const char feedback[], int wordLength) {
+    if ((int)strlen(feedback) != wordLength) {
+        return -1;
+    }
+    int pattern = 0;
+    int k = wordLength - 1;
+    for (; k >= 0; k--) {
+        if (feedback[k] < '0' || feedback[k] > '2') {
+            return -1;
+        }
+        pattern = pattern * 3 + (feedback[k] - '0');
+    }
+    return pattern;
+}
 
-void initializeLetterCountStruct(letterCountStruct* allLetters) {
-    int i = 0;
-    for (; i <= 122 - 97; i++) {
-        allLetters->letter = i + 97;
-        allLetters->appearances = 0;
-        allLetters++;
+/*
+ * Narrow the candidates down by the guesses and feedback of a request, following the decision tree as long as the
+ * guesses are the ones it would have made.
+ * Param: (const serverStateStruct*) the server, (char*[]) guess and feedback tokens, (int) number of tokens,
+ * (candidateSetStruct*) all answer words to start with, (serverRequestStruct*) the request, failed on bad input
+ * Output: The tree node of the next guess, or NULL if there is no tree or the guesses left it
+ */
+const decisionTreeNodeStruct *applyServerHistory(const serverStateStruct *server, char *tokens[], int tokenCount,
+                                                 candidateSetStruct *candidateSet, letterFrequencyStruct *frequencies,
+                                                 serverRequestStruct *request) {
+    wordleSolverStruct *solver = server->solver;
+    const decisionTreeStruct *tree = solver->tree;
+    const decisionTreeNodeStruct *node = tree != NULL ? tree->nodes : NULL;
+    if (tokenCount % 2 != 0) {
+        failRequest(request, "expected pairs of a guess word and its feedback");
+        return NULL;
+    }
+    int t = 0;
+    for (; t < tokenCount; t += 2) {
+        int guessIndex = findServerWord(server, tokens[t]);
+        int pattern = parseFeedback(tokens[t + 1], solver->matrix->wordLength);
+        if (guessIndex < 0) {
+            failRequest(request, "guess is not a word of the dictionary");
+            return NULL;
+        }
+        if (pattern < 0) {
+            failRequest(request, "feedback must be a digit 0, 1 or 2 per letter");
+            return NULL;
+        }
+        if (node != NULL) {
+            node = node->guess == guessIndex && pattern != solver->matrix->allGreenPattern
+                   ? decisionTreeChild(tree, node, pattern) : NULL;
+        }
+        solverApplyFeedback(solver, candidateSet, frequencies, candidateSetCount(candidateSet), guessIndex, pattern);
     }
+    return node;
 }
 
-void letterCompute(wordCountStruct allWords[], letterCountStruct allLetters[], int counter) {
-    //97->122
-    int i = 0;
-    for (; i < counter; i++) {
-        if (allWords->score >= 0) {
-            int j = 0;
-            for (; j < 5; j++) {
-                (allLetters+((allWords->word)[j] - 97))->appearances++;
-            }
+/*
+ * Handle one request.
+ * Param: (const serverStateStruct*) the server, (serverRequestStruct*) the request, (workerPoolStruct*) worker pool to
+ * evaluate guesses on, or NULL
+ */
+void handleServerRequest(const serverStateStruct *server, serverRequestStruct *request, workerPoolStruct *pool) {
+    wordleSolverStruct *solver = server->solver;
+    char *tokens[ 64];
+    int tokenCount = 0;
+    char *savePointer = NULL;
+    char *token = strtok_r(request->line, " \t\r\n", &savePointer);
+    for (; token != NULL; token = strtok_r(NULL, " \t\r\n", &savePointer)) {
+        if (tokenCount == 64) {
+            failRequest(request, "too many words in the request");
+            return;
         }
+        tokens[tokenCount++] = token;
     }
-    qsort(allLetters, 26, sizeof(letterCountStruct), compareFunctionLetter);
-    i = 0;
-    for (; i < counter; i++) {
-        if (allWords->score >= 0) {
-            int j = 0;
-            for (; j < 5; j++) {
-                int k = 0;
-                for (; k < 5; k++) {
-                    if ((allWords+i)->word[j] == (allLetters+k)->letter) {
-                        (allWords+i)->score+=10-k;
-                        break;
-                    }
+    if (tokenCount == 0) {
+        failRequest(request, "empty request");
+        return;
+    }
+
+    if (strcmp(tokens[0], "score") == 0) {
+        int t = 1;
+        for (; t < tokenCount; t++) {
+            if ((int)strlen(tokens[t]) != solver->matrix->wordLength) {
+                failRequest(request, "words to score must have the dictionary's length");
+                return;
+            }
+            // the same as the words files: letters only, turned to lowercase
+            int k = 0;
+            for (; k < solver->matrix->wordLength; k++) {
+                if (!isalpha((unsigned char)tokens[t][k])) {
+                    failRequest(request, "words to score must only have letters");
+                    return;
                 }
+                tokens[t][k] = (char)tolower((unsigned char)tokens[t][k]);
             }
+            packedWordStruct packedGuess;
+            packWord(tokens[t], &packedGuess, GUESS_BLANK_CODE, solver->matrix->wordLength);
+            appendResponse(request, "%s%s %d", t > 1 ? " " : "", tokens[t],
+                           packedScoreCompute(&packedGuess, &server->packedAnswers));
+        }
+        return;
+    }
+    if (strcmp(tokens[0], "guess") != 0 && strcmp(tokens[0], "filter") != 0) {
+        failRequest(request, "unknown request, expected guess, filter, score or quit");
+        return;
+    }
+
+    candidateSetStruct candidateSet;
+    initializeCandidateSet(&candidateSet, solver->answerCount);
+    letterFrequencyStruct frequencies = solver->answerFrequencies;
+    const decisionTreeNodeStruct *node = applyServerHistory(server, tokens + 1, tokenCount - 1, &candidateSet,
+                                                            &frequencies, request);
+    if (request->failed) {
+        freeCandidateSet(&candidateSet);
+        return;
+    }
+    scratchArenaStruct *arena = threadScratchArena();
+    size_t mark = arena->used;
+    int *candidates = (int *)arenaAllocate(arena, sizeof(int) * (solver->answerCount + 1));
+    int candidateCount = candidateSetIndexes(&candidateSet, candidates);
+    if (candidateCount == 0) {
+        failRequest(request, "no words left that match the feedback");
+    }
+    else if (strcmp(tokens[0], "filter") == 0) {
+        appendResponse(request, "%d", candidateCount);
+        int i = 0;
+        for (; i < candidateCount; i++) {
+            appendResponse(request, " %s", (solver->allWords + candidates[i])->word);
+        }
+    }
+    else {
+        // the same guess a game would make: from the tree while on it, then the opening guess or the best split
+        int guessIndex;
+        if (node != NULL) {
+            guessIndex = node->guess;
         }
+        else if (tokenCount == 1) {
+            guessIndex = solverOpeningGuess(solver);
+        }
+        else {
+            guessIndex = bestEntropyGuess(solver, candidates, candidateCount, &candidateSet, &frequencies, pool);
+        }
+        appendResponse(request, "%s %d", (solver->allWords + guessIndex)->word, candidateCount);
     }
-    qsort(allWords, counter, sizeof(wordCountStruct), compareFunction);
+    arenaRelease(arena, mark);
+    freeCandidateSet(&candidateSet);
 }
 
-void wordCompare()
+/*
+ * struct: serverBatchJobStruct
+ * Data shared by the worker pool threads while handling a batch of requests.
+ */
+typedef struct serverBatchJob serverBatchJobStruct;
+struct serverBatchJob{
+    const serverStateStruct *server;  // The server
+    serverRequestStruct *requests;    // The requests of the batch
+    workerPoolStruct *requestPool;    // Worker pool each request evaluates guesses on, NULL when requests run in parallel
+};
 
-void wordGuessAlgo(wordCountStruct allWords[], int guessCount) {
-    while (guessCount < 3) {
+/*
+ * Worker pool job: handle the requests from begin to end - 1 of a serverBatchJobStruct.
+ */
+void handleServerRequests(void *context, int begin, int end) {
+    serverBatchJobStruct *batchJob = (serverBatchJobStruct *)context;
+    int i = begin;
+    for (; i < end; i++) {
+        double startTime = monotonicSeconds();
+        handleServerRequest(batchJob->server, batchJob->requests + i, batchJob->requestPool);
+        (batchJob->requests + i)->seconds = monotonicSeconds() - startTime;
+    }
+}
 
+/*
+ * Handle a batch of requests and write their answers in order, then the batch line.
+ * Param: (const serverStateStruct*) the server, (serverRequestStruct[]) the requests, (int) how many, (FILE*) where to
+ * write the answers, (workerPoolStruct*) the worker pool, or NULL
+ */
+void serveBatch(const serverStateStruct *server, serverRequestStruct requests[], int requestCount, FILE *out,
+                workerPoolStruct *pool) {
+    double startTime = monotonicSeconds();
+    serverBatchJobStruct batchJob;
+    batchJob.server = server;
+    batchJob.requests = requests;
+    if (pool != NULL && pool->threadCount > 1 && requestCount > 1) {
+        batchJob.requestPool = NULL;
+        workerPoolRun(pool, handleServerRequests, &batchJob, requestCount, 1);
+    }
+    else {
+        batchJob.requestPool = pool;
+        handleServerRequests(&batchJob, 0, requestCount);
     }
+    double wallSeconds = monotonicSeconds() - startTime;
 
+    double *requestSeconds = (double *)malloc(sizeof(double) * requestCount);
+    int i = 0;
+    for (; i < requestCount; i++) {
+        serverRequestStruct *request = requests + i;
+        fprintf(out, "%s %.0f %.*s\n", request->failed ? "error" : "ok", 1e6 * request->seconds,
+                (int)request->responseLength, request->response != NULL ? request->response : "");
+        requestSeconds[i] = request->seconds;
+    }
+    qsort(requestSeconds, requestCount, sizeof(double), compareDoubles);
+    fprintf(out, "batch %d %.0f p50 %.0f max %.0f\n\n", requestCount, 1e6 * wallSeconds,
+            1e6 * percentile(requestSeconds, requestCount, 0.50), 1e6 * requestSeconds[requestCount - 1]);
+    fflush(out);
+    free(requestSeconds);
 }
 
-// -----------------------------------------------------------------------------------------
-// Find a secret word
-void findSecretWord(
-        wordCountStruct allWords[],    // Array of all the words
-        int wordCount,                  // How many words there are in allWords
-        char secretWord[])              // The word to be guessed
-{
-    char computerGuess[ 6];  // Allocate space for the computer guess
-
-    printf("Trying to find secret word: \n");
-    // Display secret word with a space between letters, to match the guess words below.
-    printf("       ");
-    for( int i=0; i<WORD_LENGTH; i++) {
-        printf("%c ", secretWord[ i]);
+/*
+ * Answer batches of requests from one client until it is done or asks the server to quit.
+ * Param: (const serverStateStruct*) the server, (FILE*) where requests come from, (FILE*) where answers go, (workerPoolStruct*)
+ * the worker pool, or NULL
+ * Output: true if the client asked the server to quit
+ */
+int serveClient(const serverStateStruct *server, FILE *in, FILE *out, workerPoolStruct *pool) {
+    serverRequestStruct *requests = NULL;
+    int requestCount = 0;
+    int capacity = 0;
+    int quit = false;
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    while (!quit) {
+        ssize_t length = getline(&line, &lineCapacity, in);
+        int blank = length > 0 && strspn(line, " \t\r\n") == (size_t)length;
+        // quit has to be the whole first word of the line
+        const char *firstWord = line + strspn(line, " \t");
+        quit = length > 0 && strncmp(firstWord, "quit", 4) == 0
+               && (firstWord[4] == '\0' || isspace((unsigned char)firstWord[4]));
+        if (length > 0 && !blank && !quit) {
+            if (requestCount == capacity) {
+                capacity = capacity < 16 ? 16 : capacity * 2;
+                requests = (serverRequestStruct *)realloc(requests, sizeof(serverRequestStruct) * capacity);
+            }
+            memset(requests + requestCount, 0, sizeof(serverRequestStruct));
+            (requests + requestCount)->line = strdup(line);
+            requestCount++;
+            continue;
+        }
+        // an empty line, quit or the end of the input finishes a batch
+        if (requestCount > 0) {
+            serveBatch(server, requests, requestCount, out, pool);
+            int i = 0;
+            for (; i < requestCount; i++) {
+                free((requests + i)->line);
+                free((requests + i)->response);
+            }
+            requestCount = 0;
+        }
+        if (length < 0) {
+            break;
+        }
     }
-    printf("\n");
-    printf("\n");
+    free(line);
+    free(requests);
+    return quit;
+}
 
-    letterCountStruct* letterCommonalities;
-    letterCommonalities = (letterCountStruct*) malloc(sizeof(letterCountStruct) * (122 - 97 + 1));
-    // Loop until the word is found
-    int guessNumber = 1;
-    while(guessNumber < 3) {
-        // Lots of code to go here ...
-        letterCompute(allWords, wordCount, letterCommonalities);
-        // ...
-        printf("%5d. \n", guessNumber);
+/*
+ * Run the server until a client asks it to quit: on stdin and stdout, or accepting clients one after the other on a
+ * Unix socket, each client's batches handled on the worker pool.
+ * Param: (wordleSolverStruct*) the solver, (char[]) path of the Unix socket, NULL for stdin and stdout,
+ * (workerPoolStruct*) the worker pool, or NULL
+ */
+void runServer(wordleSolverStruct *solver, char socketPath[], workerPoolStruct *pool) {
+    serverStateStruct server;
+    server.solver = solver;
+    // warm up everything requests share: the opening guess and the packed answers
+    if (solver->tree == NULL) {
+        solverOpeningGuess(solver);
+    }
+    packAnswers(&server.packedAnswers, solver->allWords, solver->answerCount, solver->matrix->wordLength);
+    server.wordsInOrder = (int *)malloc(sizeof(int) * solver->wordCount);
+    int i = 0;
+    for (; i < solver->wordCount; i++) {
+        server.wordsInOrder[i] = i;
+    }
+    serverWordsToSort = solver->allWords;
+    qsort(server.wordsInOrder, solver->wordCount, sizeof(int), compareWordIndexes);
 
-        // Update guess number
-        guessNumber++;
-    } //end for( int i...)
-} //end findSecretWord
+    if (socketPath == NULL) {
+        serveClient(&server, stdin, stdout, pool);
+    }
+    else {
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0 || strlen(socketPath) >= sizeof(address.sun_path)) {
+            printf("Could not make socket %s. Exiting...\n", socketPath);
+            exit(-1);
+        }
+        strcpy(address.sun_path, socketPath);
+        unlink(socketPath);
+        if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+            printf("Could not listen on socket %s. Exiting...\n", socketPath);
+            exit(-1);
+        }
+        // a client that goes away before reading its answers must not take the server down with it
+        signal(SIGPIPE, SIG_IGN);
+        printf("Serving on %s\n", socketPath);
+        fflush(stdout);
+        int quit = false;
+        while (!quit) {
+            int client = accept(listener, NULL, NULL);
+            if (client < 0) {
+                continue;
+            }
+            FILE *in = fdopen(client, "r");
+            FILE *out = fdopen(dup(client), "w");
+            quit = serveClient(&server, in, out, pool);
+            fclose(in);
+            fclose(out);
+        }
+        close(listener);
+        unlink(socketPath);
+    }
+    free(server.wordsInOrder);
+    freePackedAnswers(&server.packedAnswers);
+}
 
+// -----------------------------------------------------------------------------------------
+// Display the command line options
+void printUsage(char programName[]) {
+    printf("Usage: %s [options]\n", programName);
+    printf("  --threads N                  Use N threads for scoring, 0 for one per processor (default 1)\n");
+    printf("  --words FILE                 Play with the words in FILE instead of %s\n", WORDS_FILE_NAME);
+    printf("  --batch N                    Solve N random answer words (0 for all of them) and report statistics\n");
+    printf("  --seed S                     Seed the random number generator with S instead of the time\n");
+    printf("  --word-cache                 Load words through a binary cache next to each words file\n");
+    printf("  --best-words ANSWERS GUESSES Report the best first and second words for the two word files\n");
+    printf("  --top K                      With --best-words, also list the K highest scored first words;\n");
+    printf("                               with --lookahead, list K opening guesses\n");
+    printf("  --full-ranking               With --best-words, also list every word sorted by score\n");
+    printf("  --shards N                   With --best-words, split scoring over N forked processes\n");
+    printf("  --ranking-cache FILE         With --best-words, keep the report in FILE and reuse it while the words stay\n");
+    printf("  --worst-case-analysis        With --best-words, show the worst case of the top first words instead of\n");
+    printf("                               their second words (of every word with --full-ranking)\n");
+    printf("  --opening WORD               With --best-words, show the worst case of WORD instead of the second words\n");
+    printf("  --build-tree FILE            Write the decision tree of every game to FILE and exit\n");
+    printf("  --tree FILE                  Play from the decision tree in FILE, built for the same words\n");
+    printf("  --lookahead DEPTH            List the best opening guesses, searching DEPTH guesses ahead\n");
+    printf("  --worst-case                 Make the lookahead minimize the most candidates left, not the expected\n");
+    printf("  --lookahead-width K          Try only the K best splitting guesses at each step, 0 for all of them\n");
+    printf("  --stats                      Report time per phase and work counters on stderr when done\n");
+    printf("  --stats-json FILE            Same as --stats, also writing them to FILE as JSON\n");
+    printf("  --serve                      Answer guess, filter and score requests on stdin and stdout\n");
+    printf("  --serve-socket PATH          Answer requests from clients of the Unix socket PATH\n");
+} // end printUsage(..)
 
 // -----------------------------------------------------------------------------------------
-int main() {
+int main( int argc, char *argv[]) {
     char wordsFileName[81];                   // Stores the answers file name
     strcpy(wordsFileName, WORDS_FILE_NAME);   // Set the filename, defined at top of program.
     srand( (unsigned) time( NULL));           // Seed the random number generator to be current time
-    // Declare space for all the words, of a maximum known size.
-    wordCountStruct allWords[ MAX_NUMBER_OF_WORDS];
+    int threadCount = 1;                      // Threads used for scoring, 1 to score everything on this thread
+    int useWordCache = false;                 // Whether to load words through word cache files
+    char *answersFileName = NULL;             // Answers file for the best words report, if that was asked for
+    char *guessesFileName = NULL;             // Guesses file for the best words report
+    char *rankingCacheFileName = NULL;        // Ranking cache of the best words report, NULL to always score
+    int analyzeWorstCase = false;             // Whether the best words report analyzes the worst case of its words
+    char *openingWord = NULL;                 // Opening word to analyze the worst case of, NULL for the top words
+    int topCount = 0;                         // First words to list in the best words report
+    int fullRanking = false;                  // Whether the best words report lists every word in order
+    int batchSize = -1;                       // Games of the batch benchmark, 0 for every answer word, -1 to play interactively
+    char *buildTreeFileName = NULL;           // File to write the decision tree to, if that was asked for
+    char *treeFileName = NULL;                // Decision tree file to play from, NULL to work the guesses out
+    int serve = false;                        // Whether to run as a server instead of playing
+    int shardCount = 1;                       // Processes the best words report splits scoring over
+    int lookaheadDepth = 0;                   // Guesses the lookahead searches ahead, 0 to play instead
+    int worstCase = false;                    // Whether the lookahead minimizes the worst case
+    int lookaheadWidth = 0;                   // Guesses the lookahead tries at each step, 0 for all
+    char *socketPath = NULL;                  // Unix socket to serve on, NULL to serve on stdin and stdout
+
+    // Handle command line options
+    for( int i=1; i<argc; i++) {
+        if( strcmp( argv[ i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--words") == 0 && i + 1 < argc) {
+            snprintf( wordsFileName, sizeof( wordsFileName), "%s", argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--batch") == 0 && i + 1 < argc) {
+            batchSize = atoi( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--seed") == 0 && i + 1 < argc) {
+            srand( (unsigned) atoi( argv[ ++i]));
+        }
+        else if( strcmp( argv[ i], "--top") == 0 && i + 1 < argc) {
+            topCount = atoi( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--shards") == 0 && i + 1 < argc) {
+            shardCount = atoi( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--full-ranking") == 0) {
+            fullRanking = true;
+        }
+        else if( strcmp( argv[ i], "--build-tree") == 0 && i + 1 < argc) {
+            buildTreeFileName = argv[ ++i];
+        }
+        else if( strcmp( argv[ i], "--tree") == 0 && i + 1 < argc) {
+            treeFileName = argv[ ++i];
+        }
+        else if( strcmp( argv[ i], "--lookahead") == 0 && i + 1 < argc) {
+            lookaheadDepth = atoi( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--worst-case") == 0) {
+            worstCase = true;
+        }
+        else if( strcmp( argv[ i], "--lookahead-width") == 0 && i + 1 < argc) {
+            lookaheadWidth = atoi( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--stats") == 0) {
+            enableStats( NULL);
+        }
+        else if( strcmp( argv[ i], "--stats-json") == 0 && i + 1 < argc) {
+            enableStats( argv[ ++i]);
+        }
+        else if( strcmp( argv[ i], "--serve") == 0) {
+            serve = true;
+        }
+        else if( strcmp( argv[ i], "--serve-socket") == 0 && i + 1 < argc) {
+            serve = true;
+            socketPath = argv[ ++i];
+        }
+        else if( strcmp( argv[ i], "--word-cache") == 0) {
+            useWordCache = true;
+        }
+        else if( strcmp( argv[ i], "--ranking-cache") == 0 && i + 1 < argc) {
+            rankingCacheFileName = argv[ ++i];
+        }
+        else if( strcmp( argv[ i], "--worst-case-analysis") == 0) {
+            analyzeWorstCase = true;
+        }
+        else if( strcmp( argv[ i], "--opening") == 0 && i + 1 < argc) {
+            analyzeWorstCase = true;
+            openingWord = argv[ ++i];
+        }
+        else if( strcmp( argv[ i], "--best-words") == 0 && i + 2 < argc) {
+            answersFileName = argv[ ++i];
+            guessesFileName = argv[ ++i];
+        }
+        else {
+            printUsage( argv[ 0]);
+            exit( -1);
+        }
+    }
+    workerPoolStruct *pool = createWorkerPool( threadCount);
+    if( answersFileName != NULL) {
+        main2( answersFileName, guessesFileName, useWordCache, topCount, fullRanking, analyzeWorstCase, openingWord,
+               rankingCacheFileName, shardCount, pool);
+        freeWorkerPool( pool);
+        return 0;
+    }
+
+    // All the words, allocated and grown as they are read in.
+    wordCountStruct *allWords = NULL;
     // Start out the wordCount to be the full number of words.  This will decrease as
     //    play progresses each time through the game.
     int wordCount = 0;
     // The secret word that the computer will try to find, plus the return character from fgets.
-    char secretWord[ WORD_LENGTH + 1];
+    char secretWord[ 81];
     char userInput[ 81];                // Used for menu input of secret word
+    int wordLength = 0;                 // Length of the words, set by the words file
 
     // Read in words from file, update wordCount and display information
-    readWordsFromFile( wordsFileName, allWords, &wordCount);
-    printf("Using file %s with %d words. \n", wordsFileName, wordCount);
+    readWordsFromFile( wordsFileName, &allWords, &wordCount, &wordLength, useWordCache);
+    // while serving on stdin and stdout, everything on stdout has to be an answer
+    fprintf( serve ? stderr : stdout, "Using file %s with %d words. \n", wordsFileName, wordCount);
+    if( wordCount == 0) {
+        printf("There are no words to guess. Exiting...\n");
+        exit( -1);
+    }
+    // Build the feedback of every word against every other word once, for all the games below
+    feedbackMatrixStruct matrix;
+    buildFeedbackMatrix( &matrix, allWords, wordCount, wordCount, wordLength, pool);
+    wordleSolverStruct solver;
+    initializeWordleSolver( &solver, allWords, wordCount, &matrix, pool);
+    decisionTreeStruct tree;
+    if( buildTreeFileName != NULL) {
+        double startTime = monotonicSeconds();
+        buildDecisionTree( &tree, &solver);
+        writeDecisionTree( &tree, &solver, buildTreeFileName);
+        printf("Wrote decision tree with %d nodes to %s in %.3f s.\n", tree.nodeCount, buildTreeFileName,
+               monotonicSeconds() - startTime);
+        freeDecisionTree( &tree);
+        freeWordleSolver( &solver);
+        freeFeedbackMatrix( &matrix);
+        freeWorkerPool( pool);
+        free( allWords);
+        return 0;
+    }
+    if( lookaheadDepth > 0) {
+        runLookahead( &solver, lookaheadDepth, worstCase, lookaheadWidth, topCount > 0 ? topCount : LOOKAHEAD_SHOWN, pool);
+        freeWordleSolver( &solver);
+        freeFeedbackMatrix( &matrix);
+        freeWorkerPool( pool);
+        free( allWords);
+        return 0;
+    }
+    if( treeFileName != NULL) {
+        loadDecisionTree( &tree, &solver, treeFileName);
+        solver.tree = &tree;
+    }
+
+    if( serve) {
+        runServer( &solver, socketPath, pool);
+        if( treeFileName != NULL) {
+            freeDecisionTree( &tree);
+        }
+        freeWordleSolver( &solver);
+        freeFeedbackMatrix( &matrix);
+        freeWorkerPool( pool);
+        free( allWords);
+        return 0;
+    }
+    if( batchSize >= 0) {
+        runBatchBenchmark( &solver, batchSize, pool);
+        if( treeFileName != NULL) {
+            freeDecisionTree( &tree);
+        }
+        freeWordleSolver( &solver);
+        freeFeedbackMatrix( &matrix);
+        freeWorkerPool( pool);
+        free( allWords);
+        return 0;
+    }
 
     // Run the word-guessing game three times
     for( int i=0; i<3; i++) {
@@ -484,8 +5001,15 @@ int main() {
         }
 
         // Run the game once with the current secret word
-        findSecretWord( allWords, wordCount, secretWord);
+        findSecretWord( allWords, secretWord, &solver, pool, true);
+    }
+    if( treeFileName != NULL) {
+        freeDecisionTree( &tree);
     }
+    freeWordleSolver( &solver);
+    freeFeedbackMatrix( &matrix);
+    freeWorkerPool( pool);
+    free( allWords);
 
     printf("Done\n");
     printf("\n");